@@ -0,0 +1,157 @@
+#ifndef ASYNCLOG_H
+#define ASYNCLOG_H
+
+/*
+ASYNC LOG - Meldungen aus der Emulation, ohne auf den UART zu warten
+Serial.printf bei 115200 Baud blockiert ~87 µs pro Zeichen, sobald der
+TX-Puffer voll ist - ein HLT oder EEM/LEM in einer Schleife hat so die
+CPU auf Core 1 ausgebremst.
+
+  LOG_ERROR / LOG_WARN / LOG_INFO / LOG_DEBUG (fmt, ...)   wie printf
+
+- LOG_LEVEL (vor dem Include, Standard LOG_LEVEL_INFO): alles darüber
+  wird schon vom Compiler entfernt, auch die Argumente
+- Jeder Core darf schreiben: eine Zeile wird direkt in einen Slot des
+  Rings formatiert, der Slot wird per compare-exchange reserviert
+  (bounded MPMC-Queue nach Vyukov, hier nur ein Leser). Kein Mutex,
+  keine RTOS-Aufrufe - ist der Ring voll, wird die Zeile verworfen und
+  gezählt
+- Ein eigener Task auf Core 0 (Priorität 1 wie loop(), unter AsyncTCP
+  und WiFi) schreibt die Zeilen auf Serial und wartet dort auf den UART
+
+Interaktive Ausgaben (Speicher-Dump, Status, Hilfe) bleiben bei
+Serial.printf - sie sind länger als eine Zeile im Ring und kommen nur
+von der Konsole.
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+
+#ifndef LOG_LEVEL
+    #define LOG_LEVEL     LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_SLOTS    64     // Zweierpotenz
+#define LOG_LINE_MAX      96     // längere Zeilen werden gekürzt
+#define LOG_DRAIN_MS      10     // Ring leer: so lange schlafen
+#define LOG_TASK_STACK    3072
+
+static_assert(LOG_RING_SLOTS >= 2 && (LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0,
+              "LOG_RING_SLOTS must be a power of two (index = position & (slots - 1))");
+static_assert(LOG_LINE_MAX >= 2 && LOG_LINE_MAX <= 0xFFFF, "LOG_LINE_MAX must fit Slot::length");
+
+class AsyncLog {
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;   // == Position: frei, == Position+1: voll
+        uint16_t length;
+        char text[LOG_LINE_MAX];
+    };
+
+    Slot slots[LOG_RING_SLOTS];
+    std::atomic<uint32_t> head;           // nächste Schreib-Position (alle Cores)
+    uint32_t tail;                        // nur der Log-Task
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> written;
+    TaskHandle_t task;
+
+    static void drainTask(void* arg) {
+        AsyncLog* log = (AsyncLog*)arg;
+        while (true) {
+            if (!log->drain()) vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_MS));
+        }
+    }
+
+    // Eine Zeile ausgeben; false = Ring leer
+    bool drain() {
+        Slot& slot = slots[tail & (LOG_RING_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+        Serial.write((const uint8_t*)slot.text, slot.length);
+        slot.sequence.store(tail + LOG_RING_SLOTS, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+public:
+    AsyncLog() : head(0), tail(0), dropped(0), written(0), task(nullptr) {
+        for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Nach Serial.begin(); Zeilen von davor werden dann ausgegeben
+    void begin() {
+        xTaskCreatePinnedToCore(drainTask, "Log_Task", LOG_TASK_STACK, this, 1, &task, 0);
+    }
+
+    void vprintf(const char* format, va_list args) {
+        uint32_t position = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & (LOG_RING_SLOTS - 1)];
+            int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);   // Ring voll
+                return;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+        int length = vsnprintf(slot->text, LOG_LINE_MAX, format, args);
+        if (length < 0) length = 0;
+        if (length >= LOG_LINE_MAX) {
+            length = LOG_LINE_MAX - 1;
+            slot->text[length - 1] = '\n';   // gekürzt, Zeilenende behalten
+        }
+        slot->length = length;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+    }
+
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint32_t getWritten() const { return written.load(std::memory_order_relaxed); }
+};
+
+AsyncLog asyncLog;
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+    #define LOG_ERROR(...)  asyncLog.printf(__VA_ARGS__)
+#else
+    #define LOG_ERROR(...)  do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+    #define LOG_WARN(...)   asyncLog.printf(__VA_ARGS__)
+#else
+    #define LOG_WARN(...)   do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+    #define LOG_INFO(...)   asyncLog.printf(__VA_ARGS__)
+#else
+    #define LOG_INFO(...)   do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    #define LOG_DEBUG(...)  asyncLog.printf(__VA_ARGS__)
+#else
+    #define LOG_DEBUG(...)  do { } while (0)
+#endif
+
+#endif // ASYNCLOG_H
@@ -0,0 +1,44 @@
+// GENERIERT von tools/rim2core.py - nicht von Hand bearbeiten!
+// Quelle: programs/*.rim
+
+#ifndef CORE_IMAGES_H
+#define CORE_IMAGES_H
+
+// helloworld.rim: 37 words in 2 runs, start 0100
+static constexpr uint32_t core_helloworld_run0[] = {
+    0210112, 0764000, 0663077, 0730003, 0640100, 0600102, 0440112, 0520117,
+    0600100, 0760400, 0000113, 0706543, 0434633, 0002646, 0514364, 0000117,
+};
+static constexpr uint32_t core_helloworld_run1[] = {
+    0730002, 0327760, 0107760, 0327776, 0730002, 0327777, 0730002, 0000000,
+    0217760, 0407776, 0247776, 0447760, 0527777, 0607757, 0207776, 0407777,
+    0730002, 0327776, 0527776, 0760400, 0607751,
+};
+static constexpr CoreRun core_helloworld_runs[] = {
+    { 00100, 16, core_helloworld_run0 },
+    { 07751, 21, core_helloworld_run1 },
+};
+
+// puch_test.rim: 37 words in 2 runs, start 0400
+static constexpr uint32_t core_puch_test_run0[] = {
+    0707751, 0240416, 0230416, 0730006, 0672077, 0730006, 0672077, 0730006,
+    0200416, 0500417, 0600415, 0440416, 0600402, 0760400, 0000000, 0007777,
+};
+static constexpr uint32_t core_puch_test_run1[] = {
+    0730002, 0327760, 0107760, 0327776, 0730002, 0327777, 0730002, 0000000,
+    0217760, 0407776, 0247776, 0447760, 0527777, 0607757, 0207776, 0407777,
+    0730002, 0327776, 0527776, 0760400, 0607751,
+};
+static constexpr CoreRun core_puch_test_runs[] = {
+    { 00400, 16, core_puch_test_run0 },
+    { 07751, 21, core_puch_test_run1 },
+};
+
+static constexpr CoreImage coreImages[] = {
+    { "helloworld", 00100, core_helloworld_runs, 2 },
+    { "puch_test", 00400, core_puch_test_runs, 2 },
+};
+
+static constexpr size_t CORE_IMAGE_COUNT = 2;
+
+#endif // CORE_IMAGES_H
@@ -0,0 +1,79 @@
+#ifndef COREIMAGE_H
+#define COREIMAGE_H
+
+/*
+CORE IMAGES IM FLASH
+Programme aus den .rim-Dateien in programs/, von tools/rim2core.py vorab "geladen".
+Jedes Image besteht aus Runs zusammenhängender Speicherworte plus Start-PC.
+Laden = memcpy aus dem Flash, kein SD-Zugriff, kein emulierter RIM-Load.
+
+Auswahl:
+  - READ IN: liegt im Ordner der Sense Switches eine Datei <name>.core
+    (Inhalt egal, z.B. /5/spacewar.core), wird statt der .rim-Datei das
+    Image <name> aus dem Flash gestartet (nur per Name, keine Nummer).
+    Gibt es das Image nicht, wird die .rim-Datei des Ordners geladen.
+    Die Sense Switches wählen also weiter nur den Ordner, alle 64 Ordner
+    bleiben erreichbar.
+  - Serial 'c [name|nr]'
+  - #define BOOT_PROGRAM "name" in der .ino: startet beim Booten
+*/
+
+#include <Arduino.h>
+
+struct CoreRun {
+    uint16_t address;
+    uint16_t length;
+    const uint32_t* words;
+};
+
+struct CoreImage {
+    const char* name;
+    uint16_t startPC;
+    const CoreRun* runs;
+    uint16_t runCount;
+};
+
+#include "core_images.h"
+
+#define CORE_IMAGE_EXTENSION     ".core"   // Marker-Datei im SD-Ordner
+
+// Image nur per Name suchen (READ IN: .core-Marker), nullptr wenn nicht vorhanden
+inline const CoreImage* findCoreImageByName(const char* name) {
+    for (size_t i = 0; i < CORE_IMAGE_COUNT; i++) {
+        if (strcmp(coreImages[i].name, name) == 0) {
+            return &coreImages[i];
+        }
+    }
+    return nullptr;
+}
+
+// Image per Name oder Nummer suchen (Serial 'c', BOOT_PROGRAM)
+inline const CoreImage* findCoreImage(const char* nameOrIndex) {
+    const CoreImage* image = findCoreImageByName(nameOrIndex);
+    if (image != nullptr) return image;
+    char* end;
+    long index = strtol(nameOrIndex, &end, 10);
+    if (end != nameOrIndex && *end == 0 && index >= 0 && (size_t)index < CORE_IMAGE_COUNT) {
+        return &coreImages[index];
+    }
+    return nullptr;
+}
+
+inline const CoreImage* getCoreImage(uint8_t index) {
+    return index < CORE_IMAGE_COUNT ? &coreImages[index] : nullptr;
+}
+
+inline void listCoreImages() {
+    Serial.println("\n=== Core Images (Flash) ===");
+    for (size_t i = 0; i < CORE_IMAGE_COUNT; i++) {
+        uint32_t words = 0;
+        for (uint16_t r = 0; r < coreImages[i].runCount; r++) {
+            words += coreImages[i].runs[r].length;
+        }
+        Serial.printf("  %2u: %-16s start %04o, %lu words\n", (unsigned)i,
+                      coreImages[i].name, coreImages[i].startPC, (unsigned long)words);
+    }
+    Serial.println();
+}
+
+#endif // COREIMAGE_H
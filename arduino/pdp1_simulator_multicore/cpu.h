@@ -3,6 +3,11 @@
 
 #include <Arduino.h>
 #include <SD.h>
+#include <memory>
+#include <vector>
+#include "coreimage.h"
+#include "devicestatus.h"
+#include "display.h"
 
 // PDP-1 Architecture Constants
 #define WORD_MASK 0777777
@@ -103,18 +108,24 @@ public:
 // Forward declaration für CPU
 class PDP1;
 
+// Tape-Inhalt mit geteiltem Besitz: Web-Reader, HTTP-Download und
+// RIMLoader halten je eine eigene Referenz. Der Speicher wird erst
+// freigegeben, wenn der letzte Benutzer fertig ist.
+typedef std::shared_ptr<const std::vector<uint8_t>> TapeData;
+
 // ============================================================================
 // Paper Tape Stream - Virtuelles Paper Tape für RIM-Loader
 // ============================================================================
 class PaperTapeStream {
 private:
+    TapeData tape;          // hält den Speicher, solange der Stream lebt
     const uint8_t* data;
     size_t length;
     size_t position;
     
 public:
-    PaperTapeStream(const uint8_t* rimData, size_t len) 
-        : data(rimData), length(len), position(0) {}
+    explicit PaperTapeStream(TapeData tapeData) 
+        : tape(tapeData), data(tapeData->data()), length(tapeData->size()), position(0) {}
     
     // Liest das nächste 18-Bit Wort vom Tape
     // Filtert nur Bytes mit Bit 7 gesetzt (gültige RIM-Daten)
@@ -151,7 +162,6 @@ public:
 
 #ifdef WEBSERVER_SUPPORT
     extern bool isWebTapeMounted();
-    extern void sendReaderPosition(size_t position);
 #endif
 
 // ============================================================================
@@ -167,8 +177,7 @@ private:
     static const uint16_t RIM_LOADER_START = 07751;
     static const uint16_t RIM_LOADER_LENGTH = 43;
     
-    static bool processRIMData(const uint8_t* rimData, size_t length, 
-                              uint32_t* memory, uint16_t& startPC);
+    static bool processRIMData(TapeData tape, uint32_t* memory, uint16_t& startPC);
 
 public:
     static void setSwitchController(ISwitchController* sw) {
@@ -181,11 +190,18 @@ public:
     
     // Bestehende Funktionen
     static bool loadFromSD(const char* filename, uint32_t* memory, uint16_t& startPC);
-    static bool loadFromArray(const uint8_t* data, size_t length, 
-                             uint32_t* memory, uint16_t& startPC);
+    static bool loadFromTape(TapeData tape, uint32_t* memory, uint16_t& startPC);
     
     
 
+    // Tape aus dem Reader nehmen (z.B. bevor der Web-Tape-Buffer neu angelegt wird)
+    static void ejectTape() {
+        if (currentTape != nullptr) {
+            delete currentTape;
+            currentTape = nullptr;
+        }
+    }
+
     static uint32_t readPaperBinary() {
         // if (currentTape == nullptr || !currentTape->hasMore()) {
         //     Serial.println("  RPB: Tape leer!");
@@ -197,15 +213,13 @@ public:
                 delete currentTape;
                 currentTape = nullptr;
             }
-            Serial.println("  RPB: Tape empty!");
+            LOG_WARN("  RPB: Tape empty!\n");
             return 0;
         }
         uint32_t word = currentTape->readWord();
 
-        #ifdef WEBSERVER_SUPPORT
-            // Position-Update für Tape-Animation im Browser
-            sendReaderPosition(currentTape->getPosition());
-        #endif
+        // Position für die Tape-Animation - Core 0 schickt sie an den Browser
+        deviceStatus.setReaderPosition(currentTape->getPosition());
 
         return word;
     }
@@ -213,6 +227,7 @@ public:
     
     // Hilfsfunktionen
     static String getRIMFileFromFolder(uint8_t folderNumber);
+    static String getCoreImageFromFolder(uint8_t folderNumber);
     static void listSDFiles();
 };
 
@@ -297,10 +312,11 @@ private:
     bool running;
     bool halted;
     uint32_t cycles;
+    uint32_t simTime;         // Emulierte PDP-1 Zeit in µs (für Display-Zeitstempel)
     
-    String typewriter_buffer;
     ILEDController* leds;
     ISwitchController* switches;
+    Type30Display display;
     
     uint16_t examineAddress;
     bool powerOn;
@@ -389,6 +405,13 @@ private:
     void executeSkip(uint32_t instruction);
     void executeShift(uint32_t instruction);
     void executeIOT(uint32_t instruction);
+    
+    // Gerät beschäftigt: PC zurück, die IOT läuft im nächsten Schritt noch
+    // einmal (cpuMutex ist dazwischen frei)
+    void repeatInstruction() {
+        uint8_t bank = (PC >> 12) & 0x03;
+        PC = makeAddress(bank, (PC - 1) & ADDR_MASK);
+    }
 
 public:
     PDP1() {
@@ -434,10 +457,22 @@ public:
         switches = switchController;
     }
     
+    // Wohin die Punkte des Type 30 Displays gehen (Web, SD, off)
+    void attachDisplaySink(IDisplaySink* sink) {
+        display.attachSink(sink);
+    }
+    
+    IDisplaySink* getDisplaySink() const {
+        return display.getSink();
+    }
+    
+    uint32_t getDisplayPlotted() const { return display.getPlotted(); }
+    uint32_t getSimTime() const { return simTime; }
+    
     void stop(){
         running = false;
         halted = false;
-        Serial.println("haltet.");
+        LOG_INFO("haltet.\n");
     }
 
     void reset() {
@@ -452,7 +487,8 @@ public:
         running = false;
         halted = false;
         cycles = 0;
-        typewriter_buffer = "";
+        simTime = 0;
+        display.reset();
         examineAddress = 0;
         showRandomLEDs = false;
         
@@ -560,7 +596,7 @@ public:
         }
 
         if (!leds) {
-            Serial.println("ERROR: leds is NULL!");
+            LOG_ERROR("ERROR: leds is NULL!\n");
         return;
     }
     }
@@ -578,12 +614,14 @@ public:
     void setState(bool run) { running = run; halted = !run; }
     uint16_t getPC() const { return PC; }
     uint32_t getAC() const { return AC; }
+    uint32_t getIO() const { return IO; }
+    bool getOV() const { return OV; }
     bool getState() const { return running && !halted; }
     
     // Memory Extension Control
     void setExtendMode(bool mode) { 
         extendMode = mode; 
-        Serial.printf("[MEM] Extend Mode: %s\n", mode ? "ON" : "OFF");
+        LOG_INFO("[MEM] Extend Mode: %s\n", mode ? "ON" : "OFF");
     }
     bool getExtendMode() const { return extendMode; }
     uint8_t getCurrentBank() const { return (PC >> 12) & 0x03; }
@@ -599,10 +637,22 @@ public:
         return success;
     }
     
+    // Programm aus dem Flash laden (kein SD-Zugriff, kein RIM-Load)
+    void loadCoreImage(const CoreImage& image) {
+        RIMLoader::ejectTape();
+        reset();
+        for (uint16_t r = 0; r < image.runCount; r++) {
+            const CoreRun& run = image.runs[r];
+            memcpy(&memory[run.address], run.words, run.length * sizeof(uint32_t));
+        }
+        PC = image.startPC;
+        updateLEDs();
+    }
+    
     void run() {
         running = true;
         halted = false;
-        Serial.println("PDP-1 Running...");
+        LOG_INFO("PDP-1 Running...\n");
         updateLEDs();
     }
     
@@ -656,8 +706,7 @@ PDP1* RIMLoader::cpu = nullptr;
 // RIMLoader Implementation
 // ============================================================================
 
-bool RIMLoader::processRIMData(const uint8_t* rimData, size_t length, 
-                              uint32_t* memory, uint16_t& startPC) {
+bool RIMLoader::processRIMData(TapeData tape, uint32_t* memory, uint16_t& startPC) {
     // // Paper Tape Stream erstellen
     // PaperTapeStream tape(rimData, length);
     // currentTape = &tape;
@@ -666,13 +715,13 @@ bool RIMLoader::processRIMData(const uint8_t* rimData, size_t length,
     if (currentTape != nullptr) {
         delete currentTape;  // Altes Tape aufräumen
     }
-    currentTape = new PaperTapeStream(rimData, length);
+    currentTape = new PaperTapeStream(tape);
 
     // ====================================================================
     // PHASE 1: Hardware RIM-Mode
     // ====================================================================
     //Serial.println("=== PHASE 1: Hardware RIM-Mode ===");
-    Serial.println("Load RIM-Loader Code...\n");
+    LOG_INFO("Load RIM-Loader Code...\n\n");
     
     int wordsLoaded = 0;
     
@@ -683,12 +732,12 @@ bool RIMLoader::processRIMData(const uint8_t* rimData, size_t length,
         
         // Ende-Marker gefunden → RIM-Loader komplett
         if (firstWord == 0607751) {
-            Serial.println("\nRIM-Loader complete - End-Marker 607751 found");
+            LOG_INFO("\nRIM-Loader complete - End-Marker 607751 found\n");
             break;
         }
         
         if (!currentTape->hasMore()) {
-            Serial.println("Error: incomplete Word-pair!");
+            LOG_ERROR("Error: incomplete Word-pair!\n");
             delete currentTape;
             currentTape = nullptr;
             return false;
@@ -702,16 +751,16 @@ bool RIMLoader::processRIMData(const uint8_t* rimData, size_t length,
             wordsLoaded++;
         }
         else {
-            Serial.printf("Warning: unexpected Opcode %02o\n", opcode);
+            LOG_WARN("Warning: unexpected Opcode %02o\n", opcode);
         }
     }
     
-    Serial.printf("\nRIM-Loader: %d Words loaded\n", wordsLoaded);
+    LOG_INFO("\nRIM-Loader: %d Words loaded\n", wordsLoaded);
     
     // ====================================================================
     // PHASE 2: CPU starten - cpuTask übernimmt!
     // ====================================================================
-    Serial.println("\n=== PHASE 2: CPU starts from Memory-Loaction 7751 ===\n");
+    LOG_INFO("\n=== PHASE 2: CPU starts from Memory-Loaction 7751 ===\n\n");
     
     // if (cpu == nullptr) {
     //     Serial.println("FEHLER: CPU nicht initialisiert!");
@@ -724,7 +773,7 @@ bool RIMLoader::processRIMData(const uint8_t* rimData, size_t length,
     cpu->setAC(0);
     cpu->setIO(0);
     cpu->run();  // Startet die CPU - cpuTask auf Core 1 übernimmt!
-    Serial.println("CPU startet, wait for Core 1...");
+    LOG_INFO("CPU startet, wait for Core 1...\n");
     delay(10);  // Kurz warten damit Core 1 das Flag sieht
     // WICHTIG: currentTape NICHT auf nullptr setzen!
     // Der RIM-Loader braucht das Tape noch für RPB!
@@ -854,41 +903,38 @@ bool RIMLoader::loadFromSD(const char* filename, uint32_t* memory, uint16_t& sta
         senseValue = switches->getSenseSwitches();
     }
     
-    Serial.printf("Load from Folder %d: %s\n", senseValue, filename);
+    LOG_INFO("Load from Folder %d: %s\n", senseValue, filename);
     
     File file = SD.open(filename);
     if (!file) {
-        Serial.printf("Error: File %s not found!\n", filename);
+        LOG_ERROR("Error: File %s not found!\n", filename);
         return false;
     }
 
-    Serial.printf("Load RIM-Datei: %s (%d bytes)\n\n", filename, file.size());
+    LOG_INFO("Load RIM-Datei: %s (%d bytes)\n\n", filename, file.size());
     
-    // RIM-Datei in Byte-Array lesen
+    // RIM-Datei in Byte-Array lesen - der Reader behält es, bis der
+    // RIM-Loader auf Core 1 das Tape per RPB zu Ende gelesen hat
     size_t fileSize = file.size();
-    uint8_t* rimData = new uint8_t[fileSize];
-    file.read(rimData, fileSize);
+    std::shared_ptr<std::vector<uint8_t>> rimData = std::make_shared<std::vector<uint8_t>>(fileSize);
+    file.read(rimData->data(), fileSize);
     file.close();
     
     // Gemeinsame Verarbeitungslogik nutzen
-    bool result = processRIMData(rimData, fileSize, memory, startPC);
-    
-    delete[] rimData;
-    return result;
+    return processRIMData(rimData, memory, startPC);
 }
 
-// Laden von Byte-Array (für Webserver)
-bool RIMLoader::loadFromArray(const uint8_t* data, size_t length, 
-                             uint32_t* memory, uint16_t& startPC) {
-    if (data == nullptr || length == 0) {
-        Serial.println("Error: no Files for loading!");
+// Laden vom Web-Tape (für Webserver) - keine Kopie, nur eine Referenz mehr
+bool RIMLoader::loadFromTape(TapeData tape, uint32_t* memory, uint16_t& startPC) {
+    if (!tape || tape->empty()) {
+        LOG_ERROR("Error: no Files for loading!\n");
         return false;
     }
     
-    Serial.printf("Load RIM-Datei from Memory (%d bytes)\n\n", length);
+    LOG_INFO("Load RIM-Datei from Memory (%d bytes)\n\n", tape->size());
     
     // Gemeinsame Verarbeitungslogik nutzen
-    return processRIMData(data, length, memory, startPC);
+    return processRIMData(tape, memory, startPC);
 }
 
 // Hilfsfunktionen
@@ -929,6 +975,32 @@ String RIMLoader::getRIMFileFromFolder(uint8_t folderNumber) {
     return "";
 }
 
+// Name des Flash-Images, wenn im Ordner eine <name>.core-Datei liegt
+String RIMLoader::getCoreImageFromFolder(uint8_t folderNumber) {
+    char folderPath[16];
+    sprintf(folderPath, "/%d", folderNumber);
+    
+    File dir = SD.open(folderPath);
+    if (!dir || !dir.isDirectory()) {
+        if (dir) dir.close();
+        return "";
+    }
+    
+    String image = "";
+    while (true) {
+        File entry = dir.openNextFile();
+        if (!entry) break;
+        String name = entry.name();
+        bool isDir = entry.isDirectory();
+        entry.close();
+        if (!isDir && name.endsWith(CORE_IMAGE_EXTENSION)) {
+            image = name.substring(0, name.length() - strlen(CORE_IMAGE_EXTENSION));
+            break;
+        }
+    }
+    dir.close();
+    return image;
+}
 
 void RIMLoader::listSDFiles() {
     Serial.println("\n=== SD-Card Folders ===");
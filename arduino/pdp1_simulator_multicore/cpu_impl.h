@@ -3,12 +3,8 @@
 
 // Forward declarations für Webserver-Funktionen
 #ifdef WEBSERVER_SUPPORT
-    extern void sendTypewriterChar(uint8_t ch);
-    extern void handleDisplayOutput(int16_t x, int16_t y, uint8_t intensity);
-    extern void sendPunchData(uint8_t byte); 
     extern bool isWebTapeMounted();
-    extern std::vector<uint8_t> getWebTapeData();
-    extern void sendReaderPosition(size_t position);
+    extern TapeData getWebTape();
 #endif
 
 // Implementation of PDP1 methods that are too complex for inline
@@ -21,7 +17,7 @@ void PDP1::handleSwitches() {
     // Power Switch
     if (switches->getPower() && !powerOn) {
         powerOn = true;
-        Serial.println("Power ON");
+        LOG_INFO("Power ON\n");
         showRandomLEDs = true;
         if (leds) {
             leds->showRandomPattern();
@@ -41,7 +37,7 @@ void PDP1::handleSwitches() {
         powerOn = false;
         running = false;
         showRandomLEDs = false;
-        Serial.println("Power OFF");
+        LOG_INFO("Power OFF\n");
         reset();
         if (leds) leds->allOff();
         return;
@@ -56,20 +52,20 @@ void PDP1::handleSwitches() {
         halted = true;
         showRandomLEDs = false;
         if (leds) leds->clearRandomPattern();
-        Serial.println("STOP pressed");
+        LOG_INFO("STOP pressed\n");
     }
     
     if (switches->getStartDownPressed()) {
         if (singleStepMode) {
             step();
-            Serial.printf("STEP: PC=%04o AC=%06o\n", PC, AC);
+            LOG_INFO("STEP: PC=%04o AC=%06o\n", PC, AC);
             stepModeStop = false;
         } else {
             running = true;
             halted = false;
             showRandomLEDs = false;
             if (leds) leds->clearRandomPattern();
-            Serial.printf("START from PC=%04o\n", PC);
+            LOG_INFO("START from PC=%04o\n", PC);
         }
     }
     
@@ -77,7 +73,7 @@ void PDP1::handleSwitches() {
         PC = switches->getAddressSwitches() & ADDR_MASK;
         if (singleStepMode) {
             step();
-            Serial.printf("STEP from %04o: PC=%04o AC=%06o\n", 
+            LOG_INFO("STEP from %04o: PC=%04o AC=%06o\n", 
                           switches->getAddressSwitches() & ADDR_MASK, PC, AC);
             stepModeStop = false;
         } else {
@@ -85,7 +81,7 @@ void PDP1::handleSwitches() {
             halted = false;
             showRandomLEDs = false;
             if (leds) leds->clearRandomPattern();
-            Serial.printf("START from Address Switches: %04o\n", PC);
+            LOG_INFO("START from Address Switches: %04o\n", PC);
         }
     }
     
@@ -93,7 +89,7 @@ void PDP1::handleSwitches() {
         if (singleStepMode) {
             if (halted) halted = false;
             step();
-            Serial.printf("STEP: PC=%04o AC=%06o\n", PC, AC);
+            LOG_INFO("STEP: PC=%04o AC=%06o\n", PC, AC);
             stepModeStop = false;
         } else {
             if (halted) {
@@ -101,7 +97,7 @@ void PDP1::handleSwitches() {
                 halted = false;
                 showRandomLEDs = false;
                 if (leds) leds->clearRandomPattern();
-                Serial.println("CONTINUE");
+                LOG_INFO("CONTINUE\n");
             }
         }
     }
@@ -112,7 +108,7 @@ void PDP1::handleSwitches() {
         examineAddress = switches->getAddressSwitches() & ADDR_MASK;
         MA = examineAddress;
         MB = readMemory(examineAddress);
-        Serial.printf("EXAMINE: Addr=%04o Data=%06o\n", examineAddress, MB);
+        LOG_INFO("EXAMINE: Addr=%04o Data=%06o\n", examineAddress, MB);
     }
     
     if (switches->getDepositPressed()) {
@@ -121,47 +117,65 @@ void PDP1::handleSwitches() {
         uint16_t addr = switches->getAddressSwitches() & ADDR_MASK;
         uint32_t data = switches->getTestWord();
         writeMemory(addr, data);
-        Serial.printf("DEPOSIT: Addr=%04o Data=%06o\n", addr, data);
+        LOG_INFO("DEPOSIT: Addr=%04o Data=%06o\n", addr, data);
     }
 
     if (switches->getReadInPressed()) {
-        Serial.println("READ IN pressed");
+        LOG_INFO("READ IN pressed\n");
         
         showRandomLEDs = false;
         if (leds) leds->clearRandomPattern();
 
         #ifdef WEBSERVER_SUPPORT
             if (isWebTapeMounted()) {
-                Serial.println("[READ IN] Loading from WEB TAPE...");
+                LOG_INFO("[READ IN] Loading from WEB TAPE...\n");
                 
-                // Hole die gemounteten Tape-Daten
-                std::vector<uint8_t> tapeData = getWebTapeData();
+                // Direkt aus dem Tape-Buffer lesen (keine Kopie) - der
+                // RIMLoader hält eine eigene Referenz, ein Unmount währenddessen
+                // gibt den Speicher nicht frei
+                TapeData tape = getWebTape();
                 
-                // Lade mit loadFromArray!
                 reset();
                 uint16_t startPC = 0;
-                if (RIMLoader::loadFromArray(tapeData.data(), tapeData.size(), memory, startPC)) {
+                if (RIMLoader::loadFromTape(tape, memory, startPC)) {
                     PC = startPC;
-                    Serial.println("[READ IN] Loaded from web tape!");
+                    LOG_INFO("[READ IN] Loaded from web tape!\n");
                     updateLEDs();
                 } else {
-                    Serial.println("[READ IN] Failed to load from web tape!");
+                    LOG_ERROR("[READ IN] Failed to load from web tape!\n");
                 }
                 return;  // WICHTIG: Nicht zu SD-Karte fallen!
             } else {
-                Serial.println("[READ IN] Loading from SD CARD...");
+                LOG_INFO("[READ IN] Loading from SD CARD...\n");
             }
         #endif
         
         // Fallback: SD-Karte
         uint8_t senseValue = switches->getSenseSwitches();
+        
+        // <name>.core im Ordner: Core Image aus dem Flash statt .rim,
+        // fehlt es im Flash, geht es mit der .rim-Datei weiter
+        String imageName = RIMLoader::getCoreImageFromFolder(senseValue);
+        if (imageName.length() > 0) {
+            const CoreImage* image = findCoreImageByName(imageName.c_str());
+            if (image != nullptr) {
+                unsigned long t0 = micros();
+                loadCoreImage(*image);
+                run();
+                LOG_INFO("[READ IN] Core image %s started at %04o (%lu us)\n",
+                              image->name, image->startPC, micros() - t0);
+                return;
+            }
+            LOG_WARN("[READ IN] No core image %s in flash, loading .rim\n", imageName.c_str());
+        }
+        
         String filename = RIMLoader::getRIMFileFromFolder(senseValue);
         if (filename.length() > 0) {
             if (loadRIM(filename.c_str())) {
-                Serial.printf("[READ IN] Loaded: %s\n", filename.c_str());
+                LOG_INFO("[READ IN] Loaded: %s\n", filename.c_str());
             }
         } else {
-            Serial.println("[READ IN] No file found for sense switches");
+            LOG_WARN("[READ IN] No file found for sense switches\n");
         }
     }
     // if (switches->getReadInPressed()) {
@@ -196,7 +210,7 @@ void PDP1::handleSwitches() {
         showRandomLEDs = false;
         if (leds) leds->clearRandomPattern();
         step();
-        Serial.printf("SINGLE INSTR: PC=%04o AC=%06o\n", PC, AC);
+        LOG_INFO("SINGLE INSTR: PC=%04o AC=%06o\n", PC, AC);
     }
 
     if (!showRandomLEDs && powerOn) {
@@ -220,6 +234,10 @@ void PDP1::executeInstruction() {
     
     cycles++;
     
+    // Emulierte Zeit: 5 µs pro Speicherzyklus, Memory-Reference-Befehle
+    // brauchen zwei (Fetch + Execute)
+    simTime += (opcode <= 056) ? 10 : 5;
+    
     if (opcode <= 056 && (opcode & 1) == 0) {
         executeMemoryReference(instruction, opcode, indirect, Y);
     }
@@ -450,8 +468,8 @@ void PDP1::executeOperate(uint32_t instruction) {
     if (bits & 0400) {
         halted = true;
         running = false;
-        Serial.println("\n*** PDP-1 HALTED ***");
-        Serial.printf("Final AC=%06o IO=%06o PC=%04o Cycles=%lu\n\n", AC, IO, PC, cycles);
+        LOG_INFO("\n*** PDP-1 HALTED ***\n");
+        LOG_INFO("Final AC=%06o IO=%06o PC=%04o Cycles=%lu\n\n", AC, IO, PC, cycles);
     }
     
     if (bits & 0100) {
@@ -682,7 +700,7 @@ void PDP1::executeShift(uint32_t instruction) {
             
         default:
             // Undefinierter Sub-Opcode
-            Serial.printf("SHIFT: undefined subop %02o\n", subOp);
+            LOG_WARN("SHIFT: undefined subop %02o\n", subOp);
             break;
     }
 }
@@ -694,13 +712,13 @@ void PDP1::executeIOT(uint32_t instruction) {
     
     if (fullInstr == OP_EEM) {  // 724074 - Enter Extend Mode
         extendMode = true;
-        Serial.println("[MEM] EEM - Enter Extend Mode");
+        LOG_INFO("[MEM] EEM - Enter Extend Mode\n");
         return;
     }
     
     if (fullInstr == OP_LEM) {  // 720074 - Leave Extend Mode
         extendMode = false;
-        Serial.println("[MEM] LEM - Leave Extend Mode");
+        LOG_INFO("[MEM] LEM - Leave Extend Mode\n");
         return;
     }
     
@@ -725,22 +743,28 @@ void PDP1::executeIOT(uint32_t instruction) {
             {
                 uint8_t fiodec = IO & 077;
                 char ch = fiodecToAscii(fiodec);
-                Serial.print(ch);
-                typewriter_buffer += ch;
-                #ifdef WEBSERVER_SUPPORT
-                    sendTypewriterChar(ch);
-                #endif
+                // Lock-free an Core 0 (Serial + gesammelt ans Web).
+                // Ring voll: tyo wartet auf den Completion Pulse
+                if (!typewriterDevice.type(ch)) {
+                    repeatInstruction();
+                    break;
+                }
+                deviceStatus.countTypewriter();
             }
             break;
             
         // ====================================================================
         // 730004: Typewriter Input (Keyboard)
         // ====================================================================
+        // Zeichen aus der Tastatur-FIFO (Serial 'k' / Browser), Core 0
+        // füllt sie - die CPU fasst den UART nicht mehr an.
+        // FIODEC wird in IO Bits 12-17 (= die unteren 6 Bits, wie bei tyo)
+        // geODERt. Ohne wartende Taste bleibt IO unverändert.
+        // ====================================================================
         case 004:
-            if (Serial.available()) {
-                char ch = Serial.read();
-                IO = asciiToFiodec(ch) << 12;
-                PF[1] = true;
+            {
+                uint8_t ch;
+                if (typewriterDevice.readKey(ch)) IO |= asciiToFiodec(ch);
             }
             break;
 
@@ -756,35 +780,23 @@ void PDP1::executeIOT(uint32_t instruction) {
                 // Paper Tape Format: Bits 0-5 = Daten, Bit 7 = Sprocket
                 uint8_t tapeByte = dataBits | 0x80;
                 
-                #ifdef WEBSERVER_SUPPORT
-                    sendPunchData(tapeByte);
-                    //Serial.println(tapeByte, BIN);
-                #endif
+                // Lock-free an Core 0 (SD-Datei + Web-Animation).
+                // Ring voll: ppb wartet auf den Completion Pulse
+                if (!punchDevice.punch(tapeByte)) {
+                    repeatInstruction();
+                    break;
+                }
+                deviceStatus.countPunch();
             }
             break;
 
         // ====================================================================
-        // 730007: Display Output
+        // 730007: Display Output (Type 30)
+        // Intensität, 50 µs Plot-Zeit und IOT-Wait in display.h
         // ====================================================================
-        #ifdef WEBSERVER_SUPPORT
-            case 007:
-            {
-                uint8_t intensity = 7;  // Maximum Helligkeit
-
-                // X aus AC
-                //int16_t pdp_x = (AC & 0x3FF);
-                int16_t pdp_x = (AC >> 8) & 0x3FF;
-                if (pdp_x >= 512) pdp_x -= 1024;
-
-                // Y aus IO
-                //int16_t pdp_y = (IO & 0x3FF);
-                int16_t pdp_y = (IO >> 8) & 0x3FF;
-                if (pdp_y >= 512) pdp_y -= 1024;
-
-                handleDisplayOutput(pdp_x, pdp_y, intensity);            
-            }
+        case 007:
+            display.dpy(instruction, AC, IO, simTime);
             break;
-        #endif    
 
         // ====================================================================
         // 730012: Test Output Device (Backplane)
@@ -812,6 +824,12 @@ void PDP1::step() {
         return;
     }
     
+    // Taste angeschlagen: Program Flag 1 (Programm fragt mit szf 1 ab).
+    // Nur bei Ankunft setzen - clf 1 löscht es bis zur nächsten Taste
+    if (typewriterDevice.takeKeyArrival()) {
+        PF[1] = true;
+    }
+    
     if (!halted) {
         executeInstruction();
     }   
@@ -0,0 +1,34 @@
+#ifndef DEVICESTATUS_H
+#define DEVICESTATUS_H
+
+/*
+DEVICE STATUS
+Zähler, die die CPU (Core 1) nur hochzählt bzw. setzt - ohne Netzwerk,
+ohne Heap. Core 0 liest sie in festem Takt und schickt bei Änderung
+ein Status-Update an den Browser (sendDeviceStatus() in webserver.h).
+*/
+
+#include <stdint.h>
+#include <atomic>
+
+#define DEVICE_STATUS_INTERVAL  50   // ms, 20 Updates/s für die Tape-Animation
+
+struct DeviceStatus {
+    std::atomic<uint32_t> readerPosition{0};   // Byte-Position im Reader-Tape
+    std::atomic<uint32_t> punchCount{0};       // gestanzte Zeichen seit Start
+    std::atomic<uint32_t> typewriterCount{0};  // getippte Zeichen seit Start
+
+    void setReaderPosition(uint32_t position) {
+        readerPosition.store(position, std::memory_order_relaxed);
+    }
+    void countPunch() {
+        punchCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void countTypewriter() {
+        typewriterCount.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+DeviceStatus deviceStatus;
+
+#endif // DEVICESTATUS_H
@@ -0,0 +1,161 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+/*
+TYPE 30 DISPLAY (dpy 730007)
+  - X aus AC Bits 0-9, Y aus IO Bits 0-9 (Einerkomplement, -511..+511)
+  - Intensität aus dem Befehl: Bits 6-8 (Maske 0700), vorzeichenbehaftet
+    -4..+3, 0 = normal. Für die Senken umgerechnet auf 0..7: normal und
+    heller = 7 (so hell wie bisher jeder Punkt), -1..-4 = 6..3. Ein
+    einfaches dpy bleibt damit so hell wie vorher.
+  - Ein Punkt braucht 50 µs, danach kommt der Completion Pulse.
+  - Mit Wait-Bit (73xxxx) wartet die CPU auf den Completion Pulse,
+    ohne (72xxxx) läuft sie weiter. Ein neuer dpy, solange der vorige
+    Punkt noch geplottet wird, wartet bis das Gerät frei ist.
+  - Der Completion Pulse ist nur über das Warten sichtbar: der Simulator
+    hat keine Sequence Break und kein cks, an das er gehen könnte.
+Die Zeit ist die emulierte Zeit der CPU (PDP1::simTime, µs). Das Warten
+verschiebt nur diese Zeit (Zeitstempel der Punkte) - die Emulation wird
+dadurch in Echtzeit nicht gebremst.
+
+Die Punkte gehen an eine austauschbare Senke (IDisplaySink):
+Web (webserver.h), SD-Karte (Aufzeichnung) oder nirgendwohin.
+*/
+
+#include <Arduino.h>
+#include <SD.h>
+#include "ringbuffer.h"
+
+#define DISPLAY_PLOT_TIME_US   50
+#define IOT_WAIT_BIT           0010000   // Bit 5: auf Completion Pulse warten
+
+// ============================================================================
+// Senken-Interface
+// ============================================================================
+class IDisplaySink {
+public:
+    virtual ~IDisplaySink() {}
+    // WIRD VON CPU-TASK (CORE 1) AUFGERUFEN - nicht blockieren!
+    // x, y: -511..+511, intensity: 0..7, time: emulierte µs
+    virtual void plot(int16_t x, int16_t y, uint8_t intensity, uint32_t time) = 0;
+    virtual const char* name() const = 0;
+};
+
+class NullDisplaySink : public IDisplaySink {
+public:
+    void plot(int16_t x, int16_t y, uint8_t intensity, uint32_t time) override {}
+    const char* name() const override { return "off"; }
+};
+
+// ============================================================================
+// SD-Aufzeichnung: Core 1 -> Ring -> Core 0 schreibt /display.bin
+// Pro Punkt 8 Byte: uint32 Zeit (µs), uint32 Punkt (x | y<<10 | int<<20)
+// ============================================================================
+#define DISPLAY_REC_PATH       "/display.bin"
+#define DISPLAY_REC_RING_SIZE  4096
+
+class SDDisplaySink : public IDisplaySink {
+private:
+    SpscRing<uint32_t, DISPLAY_REC_RING_SIZE> ring;
+    File file;
+    bool recording;
+    uint32_t recorded;
+
+public:
+    SDDisplaySink() : recording(false), recorded(0) {}
+
+    void plot(int16_t x, int16_t y, uint8_t intensity, uint32_t time) override {
+        uint32_t point = ((uint32_t)intensity << 20) | (((y + 512) & 0x3FF) << 10) | ((x + 512) & 0x3FF);
+        uint32_t words[2] = { time, point };
+        ring.pushAll(words, 2);
+    }
+
+    const char* name() const override { return "sd"; }
+
+    // Core 0
+    bool start() {
+        stop();
+        file = SD.open(DISPLAY_REC_PATH, FILE_WRITE);
+        if (!file) {
+            Serial.println("[DISPLAY] Error: can't create " DISPLAY_REC_PATH);
+            return false;
+        }
+        recording = true;
+        recorded = 0;
+        Serial.println("[DISPLAY] Recording to " DISPLAY_REC_PATH);
+        return true;
+    }
+
+    void stop() {
+        if (!recording) return;
+        service();
+        file.close();
+        recording = false;
+        Serial.printf("[DISPLAY] Recording stopped: %lu points\n", (unsigned long)recorded);
+    }
+
+    // Core 0: aus loop() aufrufen
+    void service() {
+        const uint32_t* data;
+        size_t n;
+        while ((n = ring.peek(data)) > 0) {
+            if (recording) {
+                file.write((const uint8_t*)data, n * sizeof(uint32_t));
+                recorded += n / 2;
+            }
+            ring.consume(n);
+        }
+    }
+
+    uint32_t getOverflows() const { return ring.getOverflows() / 2; }
+};
+
+// ============================================================================
+// Gerät
+// ============================================================================
+class Type30Display {
+private:
+    IDisplaySink* sink;
+    uint32_t busyUntil;   // emulierte Zeit, zu der der Completion Pulse kommt
+    uint32_t plotted;
+
+public:
+    Type30Display() : sink(nullptr), busyUntil(0), plotted(0) {}
+
+    void attachSink(IDisplaySink* s) { sink = s; }
+    IDisplaySink* getSink() const { return sink; }
+
+    void reset() { busyUntil = 0; }
+
+    // simTime wird um die Wartezeit der CPU weitergezählt
+    void dpy(uint32_t instruction, uint32_t AC, uint32_t IO, uint32_t& simTime) {
+        // Gerät noch beschäftigt: erst nach dem vorigen Punkt annehmen
+        if ((int32_t)(busyUntil - simTime) > 0) {
+            simTime = busyUntil;
+        }
+
+        int16_t x = (AC >> 8) & 0x3FF;
+        if (x >= 512) x -= 1024;
+        int16_t y = (IO >> 8) & 0x3FF;
+        if (y >= 512) y -= 1024;
+
+        // -4..+3 (0 = normal) -> 3..7, normal und heller = 7
+        static const uint8_t intensityMap[8] = { 7, 7, 7, 7, 3, 4, 5, 6 };
+        uint8_t intensity = intensityMap[(instruction >> 6) & 7];
+
+        if (sink) sink->plot(x, y, intensity, simTime);
+        plotted++;
+
+        busyUntil = simTime + DISPLAY_PLOT_TIME_US;
+        if (instruction & IOT_WAIT_BIT) {
+            simTime = busyUntil;   // IOT-Wait: CPU steht bis zum Completion Pulse
+        }
+    }
+
+    uint32_t getPlotted() const { return plotted; }
+};
+
+NullDisplaySink nullDisplaySink;
+SDDisplaySink sdDisplaySink;
+
+#endif // DISPLAY_H
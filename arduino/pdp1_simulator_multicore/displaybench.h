@@ -0,0 +1,195 @@
+#ifndef DISPLAYBENCH_H
+#define DISPLAYBENCH_H
+
+/*
+DISPLAY BENCHMARK - Durchsatz der Display-Pipeline
+Serial 'a <Punkte> [Frames]' lädt ein kleines PDP-1 Programm, das pro
+Frame <Punkte> mal dpy-i ausführt (Linie, pro Frame etwas höher), und
+startet die CPU. Ohne IOT-Wait: ein Schleifendurchlauf dauert emuliert
+60 µs, länger als die 50 µs Plot-Zeit, das Display ist beim nächsten dpy
+also schon frei. Die emulierte Zeit enthält keine Display-Wartezeit.
+Nach dem HLT wird pro Stufe ausgegeben:
+
+  Interpreter  Punkte erzeugt, Wall-Zeit vs. emulierte Zeit (Core 1)
+  Punkt-Ring   verworfene Punkte (Core 0 kam nicht hinterher)
+  Encode       Zeit für Frames/JSON bauen und Einreihen (Core 0)
+  Wire         gesendete Punkte und Bytes, Backpressure-Verluste (WiFi)
+
+So lässt sich sagen, ob Interpreter, Ring, Kodierung oder WiFi bremst.
+Ohne Webserver werden nur die Interpreter-Zahlen ausgegeben.
+*/
+
+#include <Arduino.h>
+
+#define BENCH_START            0100
+#define BENCH_DATA             0200
+#define BENCH_DEFAULT_POINTS   1000
+#define BENCH_DEFAULT_FRAMES   100
+#define BENCH_DRAIN_MS         200    // nach HLT: Ring leeren lassen
+
+// Zähler der Display-Pipeline (webserver.h), alle seit Start
+struct DisplayPipelineStats {
+    uint32_t ringOverflows;     // Punkte verworfen, Ring voll
+    uint32_t pointsSent;        // an Clients eingereiht
+    uint32_t bytesSent;
+    uint32_t pointsSkipped;     // Backpressure: ausgedünnt/übersprungen
+    uint32_t framesDropped;
+    uint32_t encodeMicros;      // Frames/JSON bauen
+    uint32_t queueMicros;       // an Client-Queues hängen
+    uint32_t clients;
+};
+
+#ifdef WEBSERVER_SUPPORT
+    extern void getDisplayPipelineStats(DisplayPipelineStats& stats);
+#endif
+
+// lac mfr / dac fcn / F: lac mpt / dac pcn /
+// P: lac x / add dx / dac x / lio y / dpy-i (0720007, ohne IOT_WAIT_BIT) / isp pcn / jmp P /
+//    lac y / add dy / dac y / isp fcn / jmp F / hlt
+static constexpr uint32_t BENCH_PROGRAM[] = {
+    0200200, 0240201, 0200202, 0240203,
+    0200204, 0400206, 0240204, 0220205, 0720007, 0460203, 0600104,
+    0200205, 0400207, 0240205, 0460201, 0600102, 0760400
+};
+
+class DisplayBenchmark {
+private:
+    uint32_t data[8];
+    CoreRun runs[2];
+
+    bool active;
+    bool halted;
+    uint32_t points;
+    uint32_t frames;
+    unsigned long startMicros;
+    unsigned long haltMillis;
+    uint32_t startInstructions;
+    DisplayPipelineStats startStats;
+
+    // Zählwert für isp: nach n Erhöhungen 0 (positiv) -> skip
+    static uint32_t counter(uint32_t n) {
+        return (01000000 - n) & 0777777;
+    }
+
+    static void readStats(DisplayPipelineStats& stats) {
+        memset(&stats, 0, sizeof(stats));
+        #ifdef WEBSERVER_SUPPORT
+            getDisplayPipelineStats(stats);
+        #endif
+    }
+
+public:
+    DisplayBenchmark() : active(false), halted(false), points(0), frames(0),
+                         startMicros(0), haltMillis(0), startInstructions(0) {}
+
+    bool isActive() const { return active; }
+
+    // Mit cpuMutex aufrufen (Serial-Kommando)
+    void start(PDP1& cpu, uint32_t pointsPerFrame, uint32_t frameCount, uint32_t instructions) {
+        if (pointsPerFrame == 0) pointsPerFrame = BENCH_DEFAULT_POINTS;
+        if (frameCount == 0) frameCount = BENCH_DEFAULT_FRAMES;
+        if (pointsPerFrame > 0377777) pointsPerFrame = 0377777;
+        if (frameCount > 0377777) frameCount = 0377777;
+        points = pointsPerFrame;
+        frames = frameCount;
+
+        uint32_t step = 1000 / pointsPerFrame;
+        if (step == 0) step = 1;
+        data[0] = counter(frameCount);      // mfr
+        data[1] = 0;                        // fcn
+        data[2] = counter(pointsPerFrame);  // mpt
+        data[3] = 0;                        // pcn
+        data[4] = 0;                        // x  (Bits 0-9 = AC >> 8)
+        data[5] = 0;                        // y
+        data[6] = step << 8;                // dx
+        data[7] = 8 << 8;                   // dy
+
+        runs[0] = { BENCH_START, (uint16_t)(sizeof(BENCH_PROGRAM) / sizeof(BENCH_PROGRAM[0])), BENCH_PROGRAM };
+        runs[1] = { BENCH_DATA, 8, data };
+        CoreImage image = { "display-bench", BENCH_START, runs, 2 };
+        cpu.loadCoreImage(image);
+
+        Serial.printf("\n[BENCH] %lu points x %lu frames, display output: %s\n",
+                      (unsigned long)points, (unsigned long)frames, cpu.getDisplaySink()->name());
+
+        readStats(startStats);
+        startInstructions = instructions;
+        startMicros = micros();
+        halted = false;
+        active = true;
+        cpu.run();
+    }
+
+    // Aus loop() aufrufen: nach dem HLT kurz warten (Ring leeren), dann Bericht
+    void service(PDP1& cpu, uint32_t instructions) {
+        if (!active) return;
+        if (!halted) {
+            if (cpu.isRunning()) return;
+            halted = true;
+            haltMillis = millis();
+            report(cpu, instructions, micros() - startMicros);
+            return;
+        }
+        if (millis() - haltMillis < BENCH_DRAIN_MS) return;
+        reportPipeline(cpu.getDisplayPlotted());
+        active = false;
+    }
+
+private:
+    void report(PDP1& cpu, uint32_t instructions, unsigned long elapsed) {
+        uint32_t produced = cpu.getDisplayPlotted();
+        float seconds = elapsed / 1e6f;
+        float emulated = cpu.getSimTime() / 1e6f;
+
+        Serial.println("\n=== Display Benchmark ===");
+        Serial.printf("Interpreter: %lu instructions, %lu points in %.3f s (%.0f points/s)\n",
+                      (unsigned long)(instructions - startInstructions), (unsigned long)produced,
+                      seconds, seconds > 0 ? produced / seconds : 0.0f);
+        Serial.printf("             emulated %.3f s = %.2fx real time\n",
+                      emulated, seconds > 0 ? emulated / seconds : 0.0f);
+    }
+
+    void reportPipeline(uint32_t produced) {
+        DisplayPipelineStats now;
+        readStats(now);
+        #ifdef WEBSERVER_SUPPORT
+            uint32_t dropped = now.ringOverflows - startStats.ringOverflows;
+            uint32_t sent = now.pointsSent - startStats.pointsSent;
+            uint32_t bytes = now.bytesSent - startStats.bytesSent;
+            uint32_t skipped = now.pointsSkipped - startStats.pointsSkipped;
+            uint32_t framesDropped = now.framesDropped - startStats.framesDropped;
+            uint32_t encode = now.encodeMicros - startStats.encodeMicros;
+            uint32_t queue = now.queueMicros - startStats.queueMicros;
+
+            Serial.printf("Point ring:  %lu produced, %lu dropped (ring full)\n",
+                          (unsigned long)produced, (unsigned long)dropped);
+            Serial.printf("Encode:      %lu us build (%.2f us/point), %lu us enqueue\n",
+                          (unsigned long)encode, sent ? (float)encode / sent : 0.0f,
+                          (unsigned long)queue);
+            Serial.printf("Wire:        %lu clients, %lu points sent, %lu bytes (%.1f bytes/point)\n",
+                          (unsigned long)now.clients, (unsigned long)sent, (unsigned long)bytes,
+                          sent ? (float)bytes / sent : 0.0f);
+            Serial.printf("             backpressure: %lu frames dropped, %lu points skipped\n",
+                          (unsigned long)framesDropped, (unsigned long)skipped);
+
+            const char* limit;
+            if (now.clients == 0) {
+                limit = "no display client connected - points not sent";
+            } else if (dropped > 0) {
+                limit = "core 0 (point ring overflowed)";
+            } else if (framesDropped > 0 || skipped > 0) {
+                limit = "WiFi / client (send queues full)";
+            } else {
+                limit = "interpreter (pipeline kept up)";
+            }
+            Serial.printf("Limit:       %s\n", limit);
+        #else
+            (void)produced;
+        #endif
+        Serial.println("=========================\n");
+    }
+};
+
+DisplayBenchmark displayBenchmark;
+
+#endif // DISPLAYBENCH_H
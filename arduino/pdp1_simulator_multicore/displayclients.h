@@ -0,0 +1,208 @@
+#ifndef DISPLAYCLIENTS_H
+#define DISPLAYCLIENTS_H
+
+/*
+DISPLAY CLIENTS - Backpressure pro WebSocket-Client
+Jeder Client, der connect_dpy geschickt hat, bekommt einen Eintrag.
+Vor jedem Frame wird seine Sende-Queue (AsyncWebSocketClient::queueLen)
+angeschaut. Langsame Clients werden nach ihrer Policy gebremst, schnelle
+bekommen weiter jeden Punkt. Über DISPLAY_QUEUE_HARD wird nie mehr
+eingereiht - ein langsamer Client kann den Heap nicht mehr auffressen.
+
+Policies:
+  drop      Frames überspringen, solange der Client hinterher ist;
+            er macht danach mit dem neuesten Frame weiter
+  decimate  nur jeden 2./4./8. Punkt senden (Zeitstempel bleiben korrekt)
+  rate      nur jeden 2./4./8. Sende-Tick bedienen
+*/
+
+#include <Arduino.h>
+
+#define DISPLAY_MAX_CLIENTS    4
+#define DISPLAY_QUEUE_SOFT     4    // ab hier greift die Policy
+#define DISPLAY_QUEUE_HARD     12   // ab hier wird nichts mehr eingereiht
+#define DISPLAY_MAX_LEVEL      3    // decimate/rate: max. Faktor 2^3 = 8
+
+enum DisplayPolicy : uint8_t {
+    DISPLAY_POLICY_DROP = 0,
+    DISPLAY_POLICY_DECIMATE,
+    DISPLAY_POLICY_RATE
+};
+
+static const char* displayPolicyName(uint8_t policy) {
+    switch (policy) {
+        case DISPLAY_POLICY_DECIMATE: return "decimate";
+        case DISPLAY_POLICY_RATE:     return "rate";
+        default:                      return "drop";
+    }
+}
+
+static uint8_t displayPolicyFromName(const char* name) {
+    if (name && strcmp(name, "decimate") == 0) return DISPLAY_POLICY_DECIMATE;
+    if (name && strcmp(name, "rate") == 0)     return DISPLAY_POLICY_RATE;
+    return DISPLAY_POLICY_DROP;
+}
+
+struct DisplayClient {
+    uint32_t id;
+    bool binary;
+    bool coalesce;          // möchte zusammengefasste Frames (nur binär)
+    bool raster;            // bekommt Raster-Kacheln statt Punkte (displayraster.h)
+    bool rasterFull;        // nächster Raster-Frame komplett (neu oder Frames verpasst)
+    uint8_t policy;
+    uint8_t level;          // decimate/rate: aktueller Faktor 2^level
+    bool sendThisTick;
+    uint32_t carry;         // emulierte µs ausgelassener Punkte/Frames
+    uint32_t phase;         // Zähler für decimate
+
+    // Statistik
+    uint32_t framesSent;
+    uint32_t framesDropped;
+    uint32_t pointsSent;
+    uint32_t pointsSkipped;
+    uint32_t bytesSent;
+    uint16_t queueMax;
+};
+
+class DisplayClientTable {
+private:
+    DisplayClient clients[DISPLAY_MAX_CLIENTS];
+    size_t clientCount;
+    uint32_t tick;
+
+public:
+    DisplayClientTable() : clientCount(0), tick(0) {}
+
+    size_t count() const { return clientCount; }
+    DisplayClient& operator[](size_t i) { return clients[i]; }
+
+    DisplayClient* find(uint32_t id) {
+        for (size_t i = 0; i < clientCount; i++) {
+            if (clients[i].id == id) return &clients[i];
+        }
+        return nullptr;
+    }
+
+    // connect_dpy: neu anlegen oder Einstellungen übernehmen
+    DisplayClient* add(uint32_t id, bool binary, bool coalesce, bool raster, uint8_t policy) {
+        DisplayClient* c = find(id);
+        if (c == nullptr) {
+            if (clientCount >= DISPLAY_MAX_CLIENTS) return nullptr;
+            c = &clients[clientCount++];
+            memset(c, 0, sizeof(DisplayClient));
+            c->id = id;
+        }
+        c->binary = binary;
+        c->coalesce = binary && coalesce;
+        c->raster = raster;
+        c->rasterFull = true;
+        c->policy = policy;
+        c->level = 0;
+        return c;
+    }
+
+    void remove(uint32_t id) {
+        for (size_t i = 0; i < clientCount; i++) {
+            if (clients[i].id == id) {
+                clients[i] = clients[--clientCount];
+                return;
+            }
+        }
+    }
+
+    // Punkt-Zuschauer nach Art: zusammengefasst (merged) oder roh.
+    // Jeder Client bekommt, was er bei connect_dpy bestellt hat.
+    size_t coalesceCount() const {
+        size_t count = 0;
+        for (size_t i = 0; i < clientCount; i++) {
+            if (!clients[i].raster && clients[i].coalesce) count++;
+        }
+        return count;
+    }
+
+    size_t rawCount() const {
+        size_t count = 0;
+        for (size_t i = 0; i < clientCount; i++) {
+            if (!clients[i].raster && !clients[i].coalesce) count++;
+        }
+        return count;
+    }
+
+    size_t rasterCount() const {
+        size_t count = 0;
+        for (size_t i = 0; i < clientCount; i++) {
+            if (clients[i].raster) count++;
+        }
+        return count;
+    }
+
+    // Einmal pro Sende-Tick: Policy an die Queue-Tiefe anpassen
+    void beginTick(DisplayClient& c, size_t queueLen) {
+        if (queueLen > c.queueMax) c.queueMax = queueLen;
+
+        if (c.policy != DISPLAY_POLICY_DROP) {
+            if (queueLen >= DISPLAY_QUEUE_SOFT && c.level < DISPLAY_MAX_LEVEL) {
+                c.level++;
+            } else if (queueLen == 0 && c.level > 0) {
+                c.level--;
+            }
+        }
+        c.sendThisTick = (c.policy != DISPLAY_POLICY_RATE) ||
+                         ((tick & ((1u << c.level) - 1)) == 0);
+    }
+
+    void endTick() { tick++; }
+
+    // Pro Frame: darf der Client diesen Frame bekommen?
+    static bool shouldSend(const DisplayClient& c, size_t queueLen) {
+        if (!c.sendThisTick) return false;
+        if (queueLen >= DISPLAY_QUEUE_HARD) return false;
+        if (c.policy == DISPLAY_POLICY_DROP && queueLen >= DISPLAY_QUEUE_SOFT) return false;
+        return true;
+    }
+};
+
+// Jeden 2^level-ten Punkt übernehmen. Bei Roh-Frames wird die Zeit der
+// ausgelassenen Punkte (und übersprungener Frames, carry) auf den nächsten
+// behaltenen Punkt addiert, damit der Browser weiter in emulierter Zeit
+// altert. src enthält nur vollständige Escape-Tripel (siehe webserver.h).
+// Reicht dst nicht für ein neues Escape-Tripel, fällt der Punkt weg und
+// seine Zeit bleibt im carry.
+static size_t decimateDisplayFrame(const uint32_t* src, size_t n, bool merged, uint8_t level,
+                                   DisplayClient& c, uint32_t* dst, size_t dstMax) {
+    uint32_t mask = (1u << level) - 1;
+    size_t out = 0;
+
+    if (merged) {
+        for (size_t i = 0; i < n && out < dstMax; i++) {
+            if ((c.phase++ & mask) == 0) dst[out++] = src[i];
+        }
+        return out;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t word = src[i];
+        uint32_t dt = word >> 23;
+        if (dt == 511 && i + 2 < n) {
+            dt = src[i + 1];
+            i += 2;
+            word = src[i];
+        }
+        c.carry += dt;
+        if ((c.phase++ & mask) != 0) continue;
+
+        if (c.carry < 511) {
+            if (out + 1 > dstMax) continue;
+            dst[out++] = (word & 0x7FFFFF) | (c.carry << 23);
+        } else {
+            if (out + 3 > dstMax) continue;
+            dst[out++] = 511u << 23;
+            dst[out++] = c.carry;
+            dst[out++] = word & 0x7FFFFF;
+        }
+        c.carry = 0;
+    }
+    return out;
+}
+
+#endif // DISPLAYCLIENTS_H
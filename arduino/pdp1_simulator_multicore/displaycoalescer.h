@@ -0,0 +1,82 @@
+#ifndef DISPLAYCOALESCER_H
+#define DISPLAYCOALESCER_H
+
+/*
+DISPLAY POINT COALESCING (Core 0)
+Spacewar & Co. plotten dieselben Sterne und Schiffe viele Male pro Frame.
+Innerhalb eines Sende-Frames werden gleiche (x,y) zu einem Punkt
+zusammengefasst:
+  Bits 0-19:  x/y wie gehabt
+  Bits 20-22: hellste Intensität der Treffer
+  Bits 23-31: Anzahl Treffer (sättigt bei 511)
+Eine Summe der Intensitäten wäre bei 7 sofort gesättigt (ein normaler
+dpy hat schon 7) - die Helligkeit mehrerer Treffer steckt deshalb in der
+Trefferzahl, der Browser zeichnet den Punkt entsprechend öfter.
+Die Reihenfolge des ersten Auftretens bleibt erhalten.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#define COALESCE_SLOT_BITS  12                      // 4096 Slots, Ladefaktor <= 0.5
+#define COALESCE_SLOTS      (1 << COALESCE_SLOT_BITS)
+
+class DisplayCoalescer {
+private:
+    uint16_t slotIndex[COALESCE_SLOTS];   // Index in out[]
+    uint16_t slotGeneration[COALESCE_SLOTS];
+    uint16_t generation;
+
+    uint32_t* out;
+    size_t maxPoints;
+    size_t outCount;
+
+public:
+    DisplayCoalescer() : generation(1), out(nullptr), maxPoints(0), outCount(0) {
+        memset(slotGeneration, 0, sizeof(slotGeneration));
+    }
+
+    // Neuer Frame: Ausgabe nach buffer (max. maxCount <= COALESCE_SLOTS/2 Punkte)
+    void reset(uint32_t* buffer, size_t maxCount) {
+        out = buffer;
+        maxPoints = maxCount;
+        outCount = 0;
+        // Generation statt memset: alte Slots gelten automatisch als frei
+        if (++generation == 0) {
+            memset(slotGeneration, 0, sizeof(slotGeneration));
+            generation = 1;
+        }
+    }
+
+    // false = Frame voll, vorher senden und reset() aufrufen
+    bool add(uint32_t point) {
+        uint32_t key = point & 0xFFFFF;
+        uint32_t intensity = (point >> 20) & 7;
+        uint32_t slot = (key * 2654435761u) >> (32 - COALESCE_SLOT_BITS);
+
+        while (true) {
+            if (slotGeneration[slot] != generation) {
+                if (outCount >= maxPoints) return false;
+                slotGeneration[slot] = generation;
+                slotIndex[slot] = outCount;
+                out[outCount++] = key | (intensity << 20) | (1u << 23);
+                return true;
+            }
+
+            uint32_t& entry = out[slotIndex[slot]];
+            if ((entry & 0xFFFFF) == key) {
+                uint32_t brightest = (entry >> 20) & 7;
+                uint32_t hits = entry >> 23;
+                if (intensity > brightest) brightest = intensity;
+                if (hits < 511) hits++;
+                entry = key | (brightest << 20) | (hits << 23);
+                return true;
+            }
+            slot = (slot + 1) & (COALESCE_SLOTS - 1);
+        }
+    }
+
+    size_t count() const { return outCount; }
+};
+
+#endif // DISPLAYCOALESCER_H
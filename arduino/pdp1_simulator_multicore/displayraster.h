@@ -0,0 +1,217 @@
+#ifndef DISPLAYRASTER_H
+#define DISPLAYRASTER_H
+
+/*
+DISPLAY RASTER - serverseitig gerastertes Display (Core 0)
+Die Punkte aus dem Display-Ring werden in ein nachleuchtendes
+1024x1024 Intensitätsbild (8 Bit, PSRAM) addiert. Mit fester Bildrate
+(RASTER_FRAME_MS) werden nur geänderte 32x32-Kacheln PackBits-komprimiert
+verschickt. Die Bandbreite hängt damit von der leuchtenden Fläche ab,
+nicht von der Plot-Rate - und der Browser braucht kein WebGL (raster.html).
+
+Eine Kachel gilt als geändert, wenn sie seit dem letzten Frame getroffen
+wurde oder vor dem Nachleuchten noch nicht dunkel war.
+
+Nachricht (binär, Typ 0x03):
+  Byte 0     WS_FRAME_RASTER
+  Byte 1     Flags: Bit 0 = Vollbild, Bit 1 = erste Nachricht des Frames
+  Byte 2-3   Anzahl Kacheln (little-endian)
+  je Kachel: tx, ty (1 Byte), Länge (2 Byte LE), PackBits-Daten (32x32 Byte)
+*/
+
+#include <Arduino.h>
+
+#define WS_FRAME_RASTER       0x03
+#define RASTER_SIZE           1024
+#define RASTER_TILE           32
+#define RASTER_TILES          (RASTER_SIZE / RASTER_TILE)   // pro Achse
+#define RASTER_FRAME_MS       66      // ~15 Bilder/s
+#define RASTER_DECAY          200     // Nachleuchten: * 200/256 pro Frame
+#define RASTER_HIT_BASE       64      // Helligkeit pro Treffer bei Intensität 0
+#define RASTER_HIT_STEP       27      // + pro Intensitätsstufe (7 -> 253)
+#define RASTER_MESSAGE_MAX    8192    // wie ein Display-Frame
+#define RASTER_TILE_MAX       (RASTER_TILE * RASTER_TILE + RASTER_TILE * RASTER_TILE / 128 + 4)
+
+#define RASTER_FLAG_FULL      0x01
+#define RASTER_FLAG_FIRST     0x02
+
+class DisplayRaster {
+private:
+    uint8_t* pixels;        // RASTER_SIZE * RASTER_SIZE, PSRAM
+    uint8_t* message;       // RASTER_MESSAGE_MAX, PSRAM
+    uint8_t lit[RASTER_TILES * RASTER_TILES];     // Kachel hat helle Pixel
+    uint8_t dirty[RASTER_TILES * RASTER_TILES];   // Kachel muss gesendet werden
+    uint8_t tile[RASTER_TILE * RASTER_TILE];
+
+    // Statistik
+    uint32_t frames;
+    uint32_t tilesSent;
+    uint32_t bytesEncoded;
+    uint32_t encodeMicros;
+
+    // PackBits: 0..127 -> n+1 Literale, 129..255 -> 257-n Wiederholungen
+    static size_t packBits(const uint8_t* src, size_t n, uint8_t* dst) {
+        size_t i = 0;
+        size_t out = 0;
+        while (i < n) {
+            size_t run = 1;
+            while (i + run < n && run < 128 && src[i + run] == src[i]) run++;
+            if (run >= 2) {
+                dst[out++] = (uint8_t)(257 - run);
+                dst[out++] = src[i];
+                i += run;
+                continue;
+            }
+            size_t start = i;
+            size_t literals = 0;
+            while (i < n && literals < 128) {
+                if (i + 1 < n && src[i] == src[i + 1]) break;
+                i++;
+                literals++;
+            }
+            dst[out++] = (uint8_t)(literals - 1);
+            memcpy(dst + out, src + start, literals);
+            out += literals;
+        }
+        return out;
+    }
+
+    // Kachel aus dem Bild kopieren (PSRAM zeilenweise lesen)
+    void gatherTile(int tx, int ty) {
+        const uint8_t* src = pixels + (ty * RASTER_TILE) * RASTER_SIZE + tx * RASTER_TILE;
+        for (int row = 0; row < RASTER_TILE; row++) {
+            memcpy(&tile[row * RASTER_TILE], src + row * RASTER_SIZE, RASTER_TILE);
+        }
+    }
+
+public:
+    DisplayRaster() : pixels(nullptr), message(nullptr),
+                      frames(0), tilesSent(0), bytesEncoded(0), encodeMicros(0) {
+        memset(lit, 0, sizeof(lit));
+        memset(dirty, 0, sizeof(dirty));
+    }
+
+    // Beim ersten Raster-Client: 1 MB im PSRAM anlegen
+    bool begin() {
+        if (pixels != nullptr) return true;
+        if (!psramFound()) {
+            Serial.println("[RASTER] No PSRAM - raster display not available");
+            return false;
+        }
+        uint8_t* p = (uint8_t*)ps_malloc(RASTER_SIZE * RASTER_SIZE);
+        uint8_t* m = (uint8_t*)ps_malloc(RASTER_MESSAGE_MAX);
+        if (p == nullptr || m == nullptr) {
+            free(p);
+            free(m);
+            Serial.println("[RASTER] Error: can't allocate raster buffer");
+            return false;
+        }
+        memset(p, 0, RASTER_SIZE * RASTER_SIZE);
+        message = m;
+        pixels = p;
+        Serial.println("[RASTER] 1024x1024 raster buffer in PSRAM");
+        return true;
+    }
+
+    bool isReady() const { return pixels != nullptr; }
+
+    // Ein gepackter Punkt (x Bits 0-9, y Bits 10-19, Intensität Bits 20-22)
+    void plot(uint32_t word) {
+        uint32_t x = word & 0x3FF;
+        uint32_t row = (RASTER_SIZE - 1) - ((word >> 10) & 0x3FF);   // y nach oben
+        uint32_t intensity = (word >> 20) & 7;
+        uint8_t& pixel = pixels[row * RASTER_SIZE + x];
+        uint32_t value = pixel + RASTER_HIT_BASE + intensity * RASTER_HIT_STEP;
+        pixel = value > 255 ? 255 : value;
+        uint32_t t = (row / RASTER_TILE) * RASTER_TILES + x / RASTER_TILE;
+        lit[t] = 1;
+        dirty[t] = 1;
+    }
+
+    // Roh-Frame aus dem Display-Ring (Escape-Tripel: nur der Punkt zählt)
+    void plotFrame(const uint32_t* words, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            if ((words[i] >> 23) == 511) {
+                i += 2;
+                if (i >= n) break;
+            }
+            plot(words[i]);
+        }
+    }
+
+    // Geänderte (full: alle) Kacheln kodieren. emit(data, len, flags) wird
+    // pro Nachricht (max. RASTER_MESSAGE_MAX Bytes) aufgerufen.
+    template <typename Emit>
+    void encode(bool full, Emit emit) {
+        unsigned long start = micros();
+        size_t len = 4;
+        uint16_t count = 0;
+        uint8_t flags = (full ? RASTER_FLAG_FULL : 0) | RASTER_FLAG_FIRST;
+
+        for (int t = 0; t < RASTER_TILES * RASTER_TILES; t++) {
+            if (!full && !dirty[t]) continue;
+            if (len + 4 + RASTER_TILE_MAX > RASTER_MESSAGE_MAX) {
+                message[0] = WS_FRAME_RASTER;
+                message[1] = flags;
+                message[2] = count & 0xFF;
+                message[3] = count >> 8;
+                emit(message, len, flags);
+                bytesEncoded += len;
+                flags &= ~RASTER_FLAG_FIRST;
+                len = 4;
+                count = 0;
+            }
+            int tx = t % RASTER_TILES;
+            int ty = t / RASTER_TILES;
+            gatherTile(tx, ty);
+            size_t packed = packBits(tile, sizeof(tile), message + len + 4);
+            message[len] = tx;
+            message[len + 1] = ty;
+            message[len + 2] = packed & 0xFF;
+            message[len + 3] = packed >> 8;
+            len += 4 + packed;
+            count++;
+            tilesSent++;
+        }
+
+        if (count > 0) {
+            message[0] = WS_FRAME_RASTER;
+            message[1] = flags;
+            message[2] = count & 0xFF;
+            message[3] = count >> 8;
+            emit(message, len, flags);
+            bytesEncoded += len;
+        }
+        encodeMicros += micros() - start;
+    }
+
+    // Nach dem Senden: Nachleuchten. Was vorher hell war, ändert sich
+    // dabei und ist im nächsten Frame dirty (auch wenn es jetzt dunkel wird).
+    void decay() {
+        for (int t = 0; t < RASTER_TILES * RASTER_TILES; t++) {
+            dirty[t] = lit[t];
+            if (!lit[t]) continue;
+            uint8_t* row = pixels + (t / RASTER_TILES) * RASTER_TILE * RASTER_SIZE
+                                  + (t % RASTER_TILES) * RASTER_TILE;
+            uint8_t any = 0;
+            for (int y = 0; y < RASTER_TILE; y++, row += RASTER_SIZE) {
+                for (int x = 0; x < RASTER_TILE; x++) {
+                    uint8_t v = (row[x] * RASTER_DECAY) >> 8;
+                    row[x] = v;
+                    any |= v;
+                }
+            }
+            lit[t] = any != 0;
+        }
+        frames++;
+    }
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getTilesSent() const { return tilesSent; }
+    uint32_t getBytesEncoded() const { return bytesEncoded; }
+    uint32_t getEncodeMicros() const { return encodeMicros; }
+};
+
+DisplayRaster displayRaster;
+
+#endif // DISPLAYRASTER_H
@@ -0,0 +1,231 @@
+#ifndef MEMORYHTTP_H
+#define MEMORYHTTP_H
+
+/*
+MEMORY HTTP API - Kernspeicher lesen und schreiben (webserver.h)
+
+  GET  /memory?addr=<oktal>&count=<n>&format=oct|bin
+  POST /memory?addr=<oktal>&format=oct|bin   (Body = Worte)
+
+Lesen: der Bereich wird unter cpuMutex mit einem memcpy kopiert, die
+Antwort wird danach chunked aus dieser Kopie erzeugt - die CPU läuft
+weiter, die Antwort ist trotzdem ein konsistenter Zustand.
+
+Schreiben: der Body wird beim Empfang geparst, die Worte sammeln sich in
+einem kleinen Puffer (MEMORY_UPLOAD_BATCH Paare Adresse/Wort) und werden
+blockweise übernommen, jeder Block unter einem eigenen cpuMutex. Kein
+Abbild des ganzen Speichers, geht also auch ohne PSRAM. Bricht der Upload
+mit einem Fehler ab, sind die bis dahin übernommenen Blöcke geschrieben -
+die Antwort nennt die Anzahl.
+
+Formate:
+  bin  je Wort 4 Byte little-endian (Uint32Array im Browser)
+  oct  Zeilen "AAAAA: WWWWWW WWWWWW ..." mit 8 Worten, wie die Ausgabe.
+       Beim Schreiben setzt "AAAAA:" die Adresse, sonst fortlaufend ab addr.
+*/
+
+#include <Arduino.h>
+#include <memory>
+#include "metrics.h"
+
+#define MEMORY_WORDS_PER_LINE  8
+#define MEMORY_LINE_LEN        (6 + MEMORY_WORDS_PER_LINE * 7 + 1)   // "AAAAA:" + " WWWWWW" * 8 + "\n"
+#define MEMORY_UPLOAD_BATCH    256            // Worte pro Lock beim Schreiben
+
+enum MemoryFormat : uint8_t {
+    MEMORY_FORMAT_OCT = 0,
+    MEMORY_FORMAT_BIN
+};
+
+static uint8_t memoryFormatFromName(const char* name) {
+    return (name != nullptr && strcmp(name, "bin") == 0) ? MEMORY_FORMAT_BIN : MEMORY_FORMAT_OCT;
+}
+
+// Große Puffer lieber ins PSRAM
+static void* memoryAlloc(size_t bytes) {
+    if (psramFound()) return ps_malloc(bytes);
+    return malloc(bytes);
+}
+
+// ============================================================================
+// LESEN: Kopie eines Speicherbereichs
+// ============================================================================
+class MemorySnapshot {
+private:
+    uint32_t* words;
+    uint16_t first;
+    uint16_t count;
+
+public:
+    MemorySnapshot() : words(nullptr), first(0), count(0) {}
+    ~MemorySnapshot() { free(words); }
+
+    // Vorher anlegen, damit malloc nicht unter dem Lock läuft
+    bool reserve(uint16_t length) {
+        words = (uint32_t*)memoryAlloc(length * sizeof(uint32_t));
+        count = words ? length : 0;
+        return words != nullptr;
+    }
+
+    // Mit cpuMutex aufrufen: nur das memcpy passiert unter dem Lock
+    void copyFrom(const uint32_t* memory, uint16_t address) {
+        memcpy(words, memory + address, count * sizeof(uint32_t));
+        first = address;
+    }
+
+    size_t binarySize() const { return count * sizeof(uint32_t); }
+
+    size_t octalSize() const {
+        size_t lines = count / MEMORY_WORDS_PER_LINE;
+        size_t rest = count % MEMORY_WORDS_PER_LINE;
+        return lines * MEMORY_LINE_LEN + (rest ? 6 + rest * 7 + 1 : 0);
+    }
+
+    // Chunk-Füller für beginChunkedResponse: index = bereits gesendete Bytes
+    size_t fillBinary(uint8_t* buffer, size_t maxLen, size_t index) const {
+        size_t total = binarySize();
+        if (index >= total) return 0;
+        size_t n = total - index;
+        if (n > maxLen) n = maxLen;
+        memcpy(buffer, (const uint8_t*)words + index, n);
+        return n;
+    }
+
+    // Alle Zeilen bis auf die letzte sind gleich lang, die Position im
+    // Text ergibt sich also direkt aus index
+    size_t fillOctal(uint8_t* buffer, size_t maxLen, size_t index) const {
+        size_t out = 0;
+        char line[MEMORY_LINE_LEN + 1];
+        while (out < maxLen) {
+            size_t lineNo = (index + out) / MEMORY_LINE_LEN;
+            size_t offset = (index + out) % MEMORY_LINE_LEN;
+            size_t start = lineNo * MEMORY_WORDS_PER_LINE;
+            if (start >= count) break;
+            size_t len = formatLine(start, line);
+            if (offset >= len) break;
+            size_t n = len - offset;
+            if (n > maxLen - out) n = maxLen - out;
+            memcpy(buffer + out, line + offset, n);
+            out += n;
+        }
+        return out;
+    }
+
+private:
+    size_t formatLine(size_t start, char* line) const {
+        size_t len = sprintf(line, "%05o:", (unsigned)(first + start));
+        for (size_t i = start; i < start + MEMORY_WORDS_PER_LINE && i < count; i++) {
+            len += sprintf(line + len, " %06lo", (unsigned long)(words[i] & WORD_MASK));
+        }
+        line[len++] = '\n';
+        return len;
+    }
+};
+
+// ============================================================================
+// SCHREIBEN: Body-Parser (liegt in request->_tempObject, wird mit free()
+// freigegeben - deshalb POD, ca. 2 KB)
+// ============================================================================
+enum MemoryUploadError : uint8_t {
+    MEMORY_UPLOAD_OK = 0,
+    MEMORY_UPLOAD_INVALID,      // kaputte Daten oder Adresse außerhalb
+    MEMORY_UPLOAD_BUSY          // cpuMutex nicht bekommen
+};
+
+struct MemoryUpload {
+    uint32_t address;           // nächstes Wort
+    uint32_t written;           // bereits in den Speicher übernommen
+    uint8_t format;
+    uint8_t error;              // MemoryUploadError
+    uint8_t partial[4];         // angefangenes Binär-Wort
+    uint8_t partialLen;
+    char token[8];              // angefangene Oktalzahl
+    uint8_t tokenLen;
+    uint16_t pending;
+    uint16_t pendingAddr[MEMORY_UPLOAD_BATCH];
+    uint32_t pendingWord[MEMORY_UPLOAD_BATCH];
+
+    static MemoryUpload* create(uint32_t address, uint8_t format) {
+        MemoryUpload* upload = (MemoryUpload*)malloc(sizeof(MemoryUpload));
+        if (upload == nullptr) return nullptr;
+        memset(upload, 0, sizeof(MemoryUpload));
+        upload->address = address;
+        upload->format = format;
+        return upload;
+    }
+
+    // Gesammelte Worte unter einem eigenen Lock übernehmen
+    bool flush(uint32_t* memory) {
+        if (pending == 0) return true;
+        if (!cpuMutexTake(100)) {
+            error = MEMORY_UPLOAD_BUSY;
+            return false;
+        }
+        for (uint16_t i = 0; i < pending; i++) memory[pendingAddr[i]] = pendingWord[i];
+        xSemaphoreGive(cpuMutex);
+        written += pending;
+        pending = 0;
+        return true;
+    }
+
+    void put(uint32_t word, uint32_t* memory) {
+        if (address >= EXTENDED_MEM_SIZE) {
+            error = MEMORY_UPLOAD_INVALID;
+            return;
+        }
+        if (pending == MEMORY_UPLOAD_BATCH && !flush(memory)) return;
+        pendingAddr[pending] = (uint16_t)address++;
+        pendingWord[pending++] = word & WORD_MASK;
+    }
+
+    void endToken(bool isAddress, uint32_t* memory) {
+        if (tokenLen == 0) {
+            if (isAddress) error = MEMORY_UPLOAD_INVALID;
+            return;
+        }
+        token[tokenLen] = 0;
+        uint32_t value = strtoul(token, nullptr, 8);
+        tokenLen = 0;
+        if (isAddress) {
+            address = value;
+        } else {
+            put(value, memory);
+        }
+    }
+
+    // last = letzter Teil des Bodys: Rest prüfen und übernehmen
+    void parse(const uint8_t* data, size_t len, bool last, uint32_t* memory) {
+        for (size_t i = 0; i < len && !error; i++) {
+            if (format == MEMORY_FORMAT_BIN) {
+                partial[partialLen++] = data[i];
+                if (partialLen == 4) {
+                    put(partial[0] | (partial[1] << 8) | ((uint32_t)partial[2] << 16) |
+                        ((uint32_t)partial[3] << 24), memory);
+                    partialLen = 0;
+                }
+                continue;
+            }
+            char c = data[i];
+            if (c >= '0' && c <= '7') {
+                if (tokenLen >= 7) error = MEMORY_UPLOAD_INVALID;
+                else token[tokenLen++] = c;
+            } else if (c == ':') {
+                endToken(true, memory);
+            } else if (c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',') {
+                endToken(false, memory);
+            } else {
+                error = MEMORY_UPLOAD_INVALID;
+            }
+        }
+        if (last && !error) {
+            if (format == MEMORY_FORMAT_BIN) {
+                if (partialLen != 0) error = MEMORY_UPLOAD_INVALID;
+            } else {
+                endToken(false, memory);
+            }
+        }
+        if (last && !error) flush(memory);
+    }
+};
+
+#endif // MEMORYHTTP_H
@@ -0,0 +1,71 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+/*
+METRICS - Zähler für /metrics (Prometheus-Textformat, webserver.h)
+Die Tasks zählen nur mit relaxed atomics hoch, alles andere (Raten,
+Queue-Tiefen, Heap, Stacks) wird erst beim Abruf gelesen.
+
+cpuMutexTake() ersetzt xSemaphoreTake(cpuMutex, ...): ist der Mutex frei,
+kostet es nichts extra. Nur wenn er belegt ist, werden Konflikt und
+Wartezeit pro Core gezählt. Die Wartezeit ist ein 32-Bit-Zähler in µs
+und läuft nach ~71 Minuten Dauerwarten über (Prometheus behandelt das
+wie einen Neustart des Zählers).
+*/
+
+#include <Arduino.h>
+#include <atomic>
+
+extern SemaphoreHandle_t cpuMutex;
+
+struct Metrics {
+    std::atomic<uint32_t> mutexContended[2];     // pro Core: Take musste warten
+    std::atomic<uint32_t> mutexWaitMicros[2];    // pro Core: Summe der Wartezeit
+    std::atomic<uint32_t> mutexTimeouts{0};      // Take aufgegeben
+    std::atomic<uint32_t> ledRefreshes{0};       // updateLEDs() im CPU-Task
+    std::atomic<uint32_t> ledMatrixFrames{0};    // V2: Durchläufe des LED-Multiplexers
+
+    Metrics() {
+        for (int i = 0; i < 2; i++) {
+            mutexContended[i].store(0, std::memory_order_relaxed);
+            mutexWaitMicros[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void countLedRefresh() {
+        ledRefreshes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void countLedMatrixFrame() {
+        ledMatrixFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void print() const {
+        Serial.printf("cpuMutex: core 0 %lu waits / %lu ms, core 1 %lu waits / %lu ms, %lu timeouts\n",
+                      (unsigned long)mutexContended[0].load(std::memory_order_relaxed),
+                      (unsigned long)(mutexWaitMicros[0].load(std::memory_order_relaxed) / 1000),
+                      (unsigned long)mutexContended[1].load(std::memory_order_relaxed),
+                      (unsigned long)(mutexWaitMicros[1].load(std::memory_order_relaxed) / 1000),
+                      (unsigned long)mutexTimeouts.load(std::memory_order_relaxed));
+    }
+};
+
+Metrics metrics;
+
+// Wie xSemaphoreTake(cpuMutex, timeout) == pdTRUE, mit Konflikt-Zählung
+static inline bool cpuMutexTake(TickType_t timeout) {
+    if (xSemaphoreTake(cpuMutex, 0) == pdTRUE) return true;
+
+    int core = xPortGetCoreID() & 1;
+    metrics.mutexContended[core].fetch_add(1, std::memory_order_relaxed);
+    bool taken = false;
+    if (timeout > 0) {
+        uint32_t start = micros();
+        taken = xSemaphoreTake(cpuMutex, timeout) == pdTRUE;
+        metrics.mutexWaitMicros[core].fetch_add(micros() - start, std::memory_order_relaxed);
+    }
+    if (!taken) metrics.mutexTimeouts.fetch_add(1, std::memory_order_relaxed);
+    return taken;
+}
+
+#endif // METRICS_H
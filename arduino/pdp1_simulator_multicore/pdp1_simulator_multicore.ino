@@ -29,6 +29,15 @@ MULTICORE ARCHITECTURE:
 //uncomment to activate the webserver
 #define WEBSERVER_SUPPORT
 
+//uncomment to open an own access point (PDP-1 / spacewar1) if the WiFi is not reachable
+//#define WIFI_AP_FALLBACK
+
+//uncomment to run without front panel hardware (lamps/switches only in panel.html)
+//#define WEB_PANEL_ONLY
+
+//uncomment to start a program from flash at power on (see tools/rim2core.py)
+//#define BOOT_PROGRAM "helloworld"
+
 #include <Arduino.h>
 #include <SPI.h>
 #include <SD.h>
@@ -48,7 +57,16 @@ SemaphoreHandle_t cpuMutex = NULL;
 volatile bool DRAM_ATTR g_cpuShouldStop = false;    // Stop-Request von Core 0
 volatile bool DRAM_ATTR g_cpuIsRunning = false;     // CPU-Status für Core 0
 volatile uint32_t g_instructionsExecuted = 0;        // Performance Counter
+volatile uint32_t g_firstInstructionMicros = 0;      // Einschalten -> erster Befehl (µs)
 volatile bool DRAM_ATTR g_rimLoadingActive = false;  // NEU
+bool keyboardPassthrough = false;                    // Serial 'k': Zeilen an die Schreibmaschine
+
+// Zähler für /metrics, cpuMutexTake()
+#include "metrics.h"
+
+// Meldungen aus der Emulation über einen Ring statt direkt auf Serial
+//#define LOG_LEVEL LOG_LEVEL_WARN
+#include "asynclog.h"
 
 #ifdef BACKPLANE_SUPPORT
     #include "backplane.h"
@@ -59,9 +77,18 @@ volatile bool DRAM_ATTR g_rimLoadingActive = false;  // NEU
     }
 #endif
 
+// Paper Tape Punch (SD-Karte + Web)
+#include "punch.h"
+
+// Typewriter-Ausgabe (Serial + Web)
+#include "typewriter.h"
+
 // CPU Core einbinden
 #include "cpu.h"
 
+// Display-Benchmark (Serial 'a <Punkte> [Frames]')
+#include "displaybench.h"
+
 #ifdef WEBSERVER_SUPPORT
     #include "webserver.h"
 #endif
@@ -85,6 +112,23 @@ volatile bool DRAM_ATTR g_rimLoadingActive = false;  // NEU
     #error "please activate Version1 or Version2!"
 #endif
 
+// Front Panel im Browser (panel.html): neben der Hardware oder statt ihr
+#ifdef WEBSERVER_SUPPORT
+    #ifdef WEB_PANEL_ONLY
+        WebLEDController panelLeds(nullptr);
+        WebSwitchController panelSwitches(nullptr);
+    #else
+        WebLEDController panelLeds(&leds);
+        WebSwitchController panelSwitches(&switches);
+    #endif
+#else
+    #ifdef WEB_PANEL_ONLY
+        #error "WEB_PANEL_ONLY needs WEBSERVER_SUPPORT!"
+    #endif
+    ILEDController& panelLeds = leds;
+    ISwitchController& panelSwitches = switches;
+#endif
+
 // CPU Instanz
 PDP1 cpu;
 
@@ -107,7 +151,7 @@ void cpuTask(void* parameter) {
         // ====================================================================
         // PHASE 1: CPU-State abfragen (mit Mutex)
         // ====================================================================
-        if (xSemaphoreTake(cpuMutex, portMAX_DELAY) == pdTRUE) {
+        if (cpuMutexTake(portMAX_DELAY)) {
             
             // Stop-Signal verarbeiten
             if (g_cpuShouldStop && g_cpuIsRunning) {
@@ -131,6 +175,7 @@ void cpuTask(void* parameter) {
             // ================================================================
             if (millis() - lastLEDUpdate >= LED_UPDATE_INTERVAL) {
                 cpu.updateLEDs();
+                metrics.countLedRefresh();
                 lastLEDUpdate = millis();
             }
             
@@ -143,12 +188,12 @@ void cpuTask(void* parameter) {
                 g_cpuIsRunning = true;
                 
                 // Mutex für Instruction-Execution
-                if (xSemaphoreTake(cpuMutex, 1) == pdTRUE) {
+                if (cpuMutexTake(1)) {
                     
                     // Stop-Check VOR Execution
                     if (!g_cpuShouldStop) {
                         cpu.step();
-                        g_instructionsExecuted++;
+                        if (g_instructionsExecuted++ == 0) g_firstInstructionMicros = micros();
                     }
                     
                     // Prüfe ob CPU sich selbst gestoppt hat (HLT, etc.)
@@ -187,6 +232,7 @@ void cpuTask(void* parameter) {
 // ============================================================================
 void setup() {
     Serial.begin(115200);
+    asyncLog.begin();
     delay(2000);
     
     Serial.println("\n============================================");
@@ -212,16 +258,23 @@ void setup() {
     
     // Switch Controller initialisieren
     Serial.println("Init Switch Controller...");
-    switches.begin();
-    cpu.attachSwitches(&switches);
+    panelSwitches.begin();
+    cpu.attachSwitches(&panelSwitches);
     
-    RIMLoader::setSwitchController(&switches);
+    RIMLoader::setSwitchController(&panelSwitches);
     RIMLoader::setCPU(&cpu);
 
     // LED Controller initialisieren
     Serial.println("Init LED Controller...");
-    leds.begin();
-    cpu.attachLEDs(&leds);
+    panelLeds.begin();
+    cpu.attachLEDs(&panelLeds);
+    
+    // Type 30 Display: Punkte an den Browser, ohne Webserver nirgendwohin
+    #ifdef WEBSERVER_SUPPORT
+        cpu.attachDisplaySink(&webDisplaySink);
+    #else
+        cpu.attachDisplaySink(&nullDisplaySink);
+    #endif
     
     #ifdef BACKPLANE_SUPPORT
         bkp_mcp_init();
@@ -230,7 +283,22 @@ void setup() {
         Serial.println("Backplane Interrupt configured");
     #endif
     
+    // Boot-Programm aus dem Flash - braucht keine SD-Karte, 
+    // läuft los sobald der CPU-Task gestartet ist
+    #ifdef BOOT_PROGRAM
+        const CoreImage* bootImage = findCoreImage(BOOT_PROGRAM);
+        if (bootImage != nullptr) {
+            unsigned long t0 = micros();
+            cpu.loadCoreImage(*bootImage);
+            cpu.run();
+            Serial.printf("Boot program %s loaded in %lu us\n", bootImage->name, micros() - t0);
+        } else {
+            Serial.printf("WARNING: Boot program %s not in flash!\n", BOOT_PROGRAM);
+        }
+    #endif
+    
     // SD-Karte initialisieren
+    bool sdCardPresent = false;
     #ifdef USE_VERSION1
         delay(1000);
         Serial.println("\nInit SD-Card...");
@@ -241,6 +309,7 @@ void setup() {
             uint64_t cardSize = SD.cardSize() / (1024 * 1024);
             Serial.printf("SD-Card found: %llu MB\n", cardSize);
             RIMLoader::listSDFiles();
+            sdCardPresent = true;
         }
     #elif defined(USE_VERSION2)
         Serial.println("\nInit SD-Card...");
@@ -251,9 +320,12 @@ void setup() {
             uint64_t cardSize = SD.cardSize() / (1024 * 1024);
             Serial.printf("SD-Carte found: %llu MB\n", cardSize);
             RIMLoader::listSDFiles();
+            sdCardPresent = true;
         }
     #endif
     
+    punchDevice.begin(sdCardPresent);
+    
     // CPU-Task auf Core 1 starten
     xTaskCreatePinnedToCore(
         cpuTask,           // Task-Funktion
@@ -268,8 +340,7 @@ void setup() {
     Serial.println("CPU Task startet on Core 1");
     
     #ifdef WEBSERVER_SUPPORT
-        setup_wifi();
-        delay(100);
+        setup_wifi();       // kehrt sofort zurück
         setupWebserver();
         Serial.println("Webserver startet");
     #endif
@@ -283,6 +354,9 @@ void printHelp() {
     Serial.println("\n=== Commands ===");
     Serial.println("l <filename>  - load RIM-file");
     Serial.println("f             - list Files from SD-Card");
+    Serial.println("n [name]      - new Punch Tape ('n' alone finishes the tape)");
+    Serial.println("c [name|nr]   - start Core Image from Flash ('c' alone lists them)");
+    Serial.println("v [web|sd|off]- Display output (sd = record to /display.bin)");
     Serial.println("m             - start LED Test");
     Serial.println("r             - start CPU");
     Serial.println("s             - Stepmode");
@@ -301,6 +375,8 @@ void printHelp() {
     #ifdef WEBSERVER_SUPPORT
     Serial.println("a             - Display Test");
     #endif
+    Serial.println("a <n> [f]     - Display Benchmark: n points x f frames");
+    Serial.println("k [text]      - type text on the Typewriter ('k' alone: passthrough, '~.' ends)");
     Serial.println("========================\n");
 }
 
@@ -309,20 +385,12 @@ void printHelp() {
 // ============================================================================
 void loop() {
 
-    // ========================================================================
-    // VERSION 2: Matrix Refresh (muss auf Core 0 bleiben wegen SPI-Sharing)
-    // ========================================================================
-    #ifdef USE_VERSION2
-        static unsigned long lastMatrixRefresh = 0;
-        static const unsigned long MATRIX_REFRESH_INTERVAL = 8;  // 8ms = ~120 Hz
-        
-        if (millis() - lastMatrixRefresh >= MATRIX_REFRESH_INTERVAL) {
-            leds.forceRefresh();
-            lastMatrixRefresh = millis();
-        }
-    #endif
+    // VERSION 2: die LED-Matrix multiplext ein Timer-Task auf Core 0 (version2.h)
 
     #ifdef WEBSERVER_SUPPORT
+        // WLAN im Hintergrund verbinden / wiederverbinden
+        wifiLink.service();
+        
         // WebSocket Cleanup (seltener!)
         static unsigned long lastWSCleanup = 0;
         if (millis() - lastWSCleanup > 10000) {  // Alle 10 Sekunden
@@ -332,23 +400,42 @@ void loop() {
 
         static unsigned long lastSend = 0;
         if (millis() - lastSend >= 33) {
-            if (!displayBuffer.empty() && displayConnected && ws.count()) {
-                sendDisplayPointsBatch();
-            }
+            sendDisplayPointsBatch();
+            lastSend = millis();
+        }
 
-        // PUNCH BATCH SENDEN (NEU!)
-        if (!punchBuffer.empty() && ws.count()) {
-            sendPunchDataBatch();
+        // Front Panel im Browser: geänderte Lampen, max. ~60 Hz
+        static unsigned long lastPanel = 0;
+        if (millis() - lastPanel >= PANEL_FRAME_MS) {
+            sendPanelLamps();
+            lastPanel = millis();
         }
-            lastSend = millis();
+
+        // Status-Zähler von Core 1 abtasten (Reader-Position, Punch, Typewriter)
+        static unsigned long lastStatus = 0;
+        if (millis() - lastStatus >= DEVICE_STATUS_INTERVAL) {
+            sendDeviceStatus();
+            lastStatus = millis();
         }
     #endif
 
+    // Paper Tape Punch: Ring von Core 1 auf SD-Karte / Web leeren
+    punchDevice.service();
+    
+    // Typewriter: Ring von Core 1 auf Serial / Web leeren
+    typewriterDevice.service();
+    
+    // Display-Aufzeichnung auf SD (nur wenn als Senke gewählt)
+    sdDisplaySink.service();
+    
+    // Display-Benchmark: Bericht nach dem HLT
+    displayBenchmark.service(cpu, g_instructionsExecuted);
+
     #ifdef BACKPLANE_SUPPORT
         if (g_backplaneInterruptFlag) {
             g_backplaneInterruptFlag = false;
             uint8_t flags = bkp_read_programflags();
-            if (xSemaphoreTake(cpuMutex, 10) == pdTRUE) {
+            if (cpuMutexTake(10)) {
                 cpu.setProgramFlags(flags);
                 xSemaphoreGive(cpuMutex);
             }
@@ -379,7 +466,7 @@ void loop() {
     #endif   
 
     // Hardware-Schalter verarbeiten (mit Mutex-Schutz)
-    if (xSemaphoreTake(cpuMutex, 5) == pdTRUE) {
+    if (cpuMutexTake(5)) {
         cpu.handleSwitches();
         xSemaphoreGive(cpuMutex);
     }
@@ -389,12 +476,26 @@ void loop() {
         String input = Serial.readStringUntil('\n');
         input.trim();
         
+        // Tastatur-Modus: jede Zeile geht an die Schreibmaschine, '~.' beendet
+        if (keyboardPassthrough) {
+            if (input == "~.") {
+                keyboardPassthrough = false;
+                Serial.println("\n[KEYBOARD] Passthrough off");
+            } else {
+                typewriterDevice.pushKeys(input.c_str());
+                if (!typewriterDevice.pushKey('\r')) {
+                    Serial.println("[KEYBOARD] Key FIFO full - input dropped");
+                }
+            }
+            return;
+        }
+        
         if (input.length() == 0) return;
         
         char cmd = input.charAt(0);
         
         // Mutex für alle CPU-Operationen
-        if (xSemaphoreTake(cpuMutex, 100) == pdTRUE) {
+        if (cpuMutexTake(100)) {
             switch(cmd) {
                 case 'l':
                 case 'L':
@@ -419,6 +520,71 @@ void loop() {
                 case 'f':
                 case 'F':
                     RIMLoader::listSDFiles();
+                    punchDevice.listTapes();
+                    break;
+                    
+                case 'c':
+                case 'C':
+                    {
+                        int spacePos = input.indexOf(' ');
+                        if (spacePos > 0) {
+                            String name = input.substring(spacePos + 1);
+                            name.trim();
+                            const CoreImage* image = findCoreImage(name.c_str());
+                            if (image != nullptr) {
+                                unsigned long t0 = micros();
+                                cpu.loadCoreImage(*image);
+                                cpu.run();
+                                Serial.printf("Core image %s started at %04o (%lu us)\n",
+                                              image->name, image->startPC, micros() - t0);
+                            } else {
+                                Serial.printf("Core image '%s' not found\n", name.c_str());
+                            }
+                        } else {
+                            listCoreImages();
+                        }
+                    }
+                    break;
+                    
+                case 'v':
+                case 'V':
+                    {
+                        int spacePos = input.indexOf(' ');
+                        String target = (spacePos > 0) ? input.substring(spacePos + 1) : "";
+                        target.trim();
+                        
+                        if (target.length() > 0 && cpu.getDisplaySink() == &sdDisplaySink) {
+                            sdDisplaySink.stop();
+                        }
+                        if (target == "off") {
+                            cpu.attachDisplaySink(&nullDisplaySink);
+                        } else if (target == "sd") {
+                            if (sdDisplaySink.start()) {
+                                cpu.attachDisplaySink(&sdDisplaySink);
+                            }
+                        #ifdef WEBSERVER_SUPPORT
+                        } else if (target == "web") {
+                            cpu.attachDisplaySink(&webDisplaySink);
+                        #endif
+                        } else if (target.length() > 0) {
+                            Serial.println("Unknown display output");
+                        }
+                        Serial.printf("Display output: %s\n", cpu.getDisplaySink()->name());
+                    }
+                    break;
+                    
+                case 'n':
+                case 'N':
+                    {
+                        int spacePos = input.indexOf(' ');
+                        if (spacePos > 0) {
+                            String name = input.substring(spacePos + 1);
+                            name.trim();
+                            punchDevice.newTape(name.c_str());
+                        } else {
+                            punchDevice.finishTape();
+                        }
+                    }
                     break;
                     
                 case 'm':
@@ -460,19 +626,19 @@ void loop() {
                     
                 case 'w':
                 case 'W':
-                    switches.printStatus();
+                    panelSwitches.printStatus();
                     break;
                     
                 case 't':
                 case 'T':
+                    // V2 kehrt sofort zurück; das Ende meldet der Controller selbst
                     Serial.println("Start LED Test Pattern...");
-                    leds.testPattern();
-                    Serial.println("LED Test finished");
+                    panelLeds.testPattern();
                     break;
                     
                 case 'o':
                 case 'O':
-                    leds.allOff();
+                    panelLeds.allOff();
                     Serial.println("Alle LEDs off");
                     break;
                     
@@ -489,7 +655,7 @@ void loop() {
                         cpu.setExtendMode(newMode);
                         Serial.printf("Extend Mode: %s\n", newMode ? "ON" : "OFF");
                         Serial.printf("(Hardware Switch: %s)\n", 
-                            switches.getExtendSwitch() ? "ON" : "OFF");
+                            panelSwitches.getExtendSwitch() ? "ON" : "OFF");
                     }
                     break;
                     
@@ -500,7 +666,20 @@ void loop() {
                     Serial.printf("Loop on Core: %d\n", xPortGetCoreID());
                     Serial.printf("CPU Running: %s\n", g_cpuIsRunning ? "YES" : "NO");
                     Serial.printf("Instructions: %lu\n", g_instructionsExecuted);
+                    Serial.printf("First Instruction: %lu ms after power-on\n", g_firstInstructionMicros / 1000);
                     Serial.printf("Free Heap: %d bytes\n", ESP.getFreeHeap());
+                    #ifdef WEBSERVER_SUPPORT
+                    printDisplayStats();
+                    webAssets.printStats();
+                    printWsCommandStats();
+                    wifiLink.printStatus();
+                    #endif
+                    metrics.print();
+                    #if defined(USE_VERSION2) && !defined(WEB_PANEL_ONLY)
+                    leds.printStats();
+                    #endif
+                    Serial.printf("Log: %lu lines, %lu dropped (ring full)\n",
+                                  (unsigned long)asyncLog.getWritten(), (unsigned long)asyncLog.getDropped());
                     Serial.printf("Memory: %d Banks x %d Words = %d KB\n", 
                         MEMORY_BANKS, BANK_SIZE, (EXTENDED_MEM_SIZE * 4) / 1024);
                     Serial.println("========================\n");
@@ -518,12 +697,45 @@ void loop() {
                     break;
                 #endif
 
-                #ifdef WEBSERVER_SUPPORT
                 case 'a':
                 case 'A':
-                    testDisplay();
+                    {
+                        int spacePos = input.indexOf(' ');
+                        if (spacePos > 0) {
+                            // a <Punkte pro Frame> [Frames]
+                            String args = input.substring(spacePos + 1);
+                            args.trim();
+                            int secondSpace = args.indexOf(' ');
+                            uint32_t points = args.toInt();
+                            uint32_t frames = (secondSpace > 0) ? args.substring(secondSpace + 1).toInt() : 0;
+                            displayBenchmark.start(cpu, points, frames, g_instructionsExecuted);
+                        } else {
+                            #ifdef WEBSERVER_SUPPORT
+                                testDisplay();
+                            #else
+                                Serial.println("Usage: a <points> [frames]");
+                            #endif
+                        }
+                    }
+                    break;
+
+                case 'k':
+                case 'K':
+                    {
+                        int spacePos = input.indexOf(' ');
+                        if (spacePos > 0) {
+                            // k <Text>: Text + CR an die Schreibmaschine
+                            String text = input.substring(spacePos + 1);
+                            size_t n = typewriterDevice.pushKeys(text.c_str());
+                            if (n < text.length() || !typewriterDevice.pushKey('\r')) {
+                                Serial.println("[KEYBOARD] Key FIFO full - input truncated");
+                            }
+                        } else {
+                            keyboardPassthrough = true;
+                            Serial.println("[KEYBOARD] Passthrough on - every line is typed, '~.' ends");
+                        }
+                    }
                     break;
-                #endif
 
                 default:
                     Serial.println("unknwon Command. 'h' für Hilfe.");
@@ -0,0 +1,352 @@
+#ifndef PUNCH_H
+#define PUNCH_H
+
+/*
+PAPER TAPE PUNCH (ppb 720006)
+Core 1 (CPU) schreibt Bytes lock-free in einen Ring,
+Core 0 (Main Loop) leert den Ring gepuffert in eine Datei auf der SD-Karte
+und reicht die Bytes an den Webserver (Tape-Animation) weiter.
+
+Jedes Tape ist eine eigene Datei unter /punch/ mit Leader und Trailer
+(Leerband = 0x00). Fertige Tapes können per HTTP geladen werden.
+*/
+
+#include <Arduino.h>
+#include <SD.h>
+#include "ringbuffer.h"
+
+#ifdef WEBSERVER_SUPPORT
+    extern void sendPunchDataBatch(const uint8_t* data, size_t len);
+#endif
+
+#define PUNCH_DIR              "/punch"
+#define PUNCH_RING_SIZE        4096   // Core 1 -> Core 0
+#define PUNCH_FILE_BUFFER      512    // ein SD-Sektor pro write()
+#define PUNCH_WEB_BUFFER       1024
+#define PUNCH_WEB_INTERVAL     33     // ms, wie der Display-Batch
+#define PUNCH_LEADER_LENGTH    100    // 10 Zoll Leerband (10 Zeichen/Zoll)
+#define PUNCH_FLUSH_IDLE_MS    1000   // offene Datei nach Pause auf SD schreiben
+#define PUNCH_STALL_MAX_MS     50     // voller Ring: so lange bleibt ppb beschäftigt
+#define PUNCH_NAME_MAX         24
+
+// Ergebnis von requestNewTape() - der Webserver meldet es dem Client
+enum PunchRequest : uint8_t {
+    PUNCH_REQUEST_OK = 0,
+    PUNCH_REQUEST_BUSY,         // vorherige Anforderung noch nicht ausgeführt
+    PUNCH_REQUEST_INVALID,      // ungültiger Name
+    PUNCH_REQUEST_EXISTS        // Tape gibt es schon, wird nicht überschrieben
+};
+
+class PunchDevice {
+private:
+    SpscRing<uint8_t, PUNCH_RING_SIZE> ring;
+    RingOutputStall stall;
+
+    bool sdAvailable;
+    File tapeFile;
+    bool tapeOpen;
+    char tapeName[PUNCH_NAME_MAX + 1];
+    uint32_t tapeBytes;
+    uint16_t nextTapeNumber;
+
+    uint8_t fileBuffer[PUNCH_FILE_BUFFER];
+    size_t fileBufferLen;
+    unsigned long lastPunchTime;
+
+    // Tape-Wechsel aus dem Webserver-Task wird in service() ausgeführt
+    volatile bool pendingRequest;
+    volatile bool pendingFinishOnly;
+    char pendingName[PUNCH_NAME_MAX + 1];
+
+    uint8_t webBuffer[PUNCH_WEB_BUFFER];
+    size_t webBufferLen;
+    unsigned long lastWebSend;
+
+    static bool isValidName(const char* name) {
+        size_t len = strlen(name);
+        if (len == 0 || len > PUNCH_NAME_MAX) return false;
+        for (size_t i = 0; i < len; i++) {
+            char c = name[i];
+            bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                      (c >= '0' && c <= '9') || c == '_' || c == '-';
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    static void makePath(char* path, size_t size, const char* name) {
+        snprintf(path, size, "%s/%s.bin", PUNCH_DIR, name);
+    }
+
+    bool tapeExists(const char* name) const {
+        char path[48];
+        makePath(path, sizeof(path), name);
+        return sdAvailable && SD.exists(path);
+    }
+
+    void writeFile(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            size_t n = PUNCH_FILE_BUFFER - fileBufferLen;
+            if (n > len) n = len;
+            memcpy(fileBuffer + fileBufferLen, data, n);
+            fileBufferLen += n;
+            data += n;
+            len -= n;
+            if (fileBufferLen == PUNCH_FILE_BUFFER) {
+                flushFile();
+            }
+        }
+    }
+
+    void flushFile() {
+        if (fileBufferLen == 0) return;
+        if (tapeOpen) {
+            tapeFile.write(fileBuffer, fileBufferLen);
+        }
+        fileBufferLen = 0;
+    }
+
+    void writeBlank(size_t count) {
+        static const uint8_t blank[32] = { 0 };
+        while (count > 0) {
+            size_t n = count < sizeof(blank) ? count : sizeof(blank);
+            writeFile(blank, n);
+            count -= n;
+        }
+    }
+
+    void drainRing() {
+        const uint8_t* data;
+        size_t n;
+        while ((n = ring.peek(data)) > 0) {
+            if (sdAvailable) {
+                if (!tapeOpen) {
+                    newTape(nullptr);
+                }
+                writeFile(data, n);
+                tapeBytes += n;
+            }
+            appendWeb(data, n);
+            ring.consume(n);
+            lastPunchTime = millis();
+        }
+    }
+
+    void flushWeb() {
+        #ifdef WEBSERVER_SUPPORT
+            if (webBufferLen > 0) {
+                sendPunchDataBatch(webBuffer, webBufferLen);
+            }
+        #endif
+        webBufferLen = 0;
+        lastWebSend = millis();
+    }
+
+    void appendWeb(const uint8_t* data, size_t len) {
+        #ifdef WEBSERVER_SUPPORT
+            while (len > 0) {
+                size_t n = PUNCH_WEB_BUFFER - webBufferLen;
+                if (n > len) n = len;
+                memcpy(webBuffer + webBufferLen, data, n);
+                webBufferLen += n;
+                data += n;
+                len -= n;
+                if (webBufferLen == PUNCH_WEB_BUFFER) {
+                    flushWeb();
+                }
+            }
+        #endif
+    }
+
+public:
+    PunchDevice() {
+        sdAvailable = false;
+        tapeOpen = false;
+        tapeName[0] = 0;
+        tapeBytes = 0;
+        nextTapeNumber = 1;
+        fileBufferLen = 0;
+        lastPunchTime = 0;
+        webBufferLen = 0;
+        lastWebSend = 0;
+        pendingRequest = false;
+        pendingFinishOnly = false;
+        pendingName[0] = 0;
+    }
+
+    // Nach SD.begin() aufrufen (Core 0)
+    void begin(bool sdCardPresent) {
+        sdAvailable = sdCardPresent;
+        if (!sdAvailable) {
+            Serial.println("[PUNCH] No SD-Card - punch output only to web");
+            return;
+        }
+
+        if (!SD.exists(PUNCH_DIR)) {
+            SD.mkdir(PUNCH_DIR);
+        }
+
+        // Höchste vorhandene tapeNNN-Nummer suchen
+        File dir = SD.open(PUNCH_DIR);
+        if (dir && dir.isDirectory()) {
+            while (true) {
+                File entry = dir.openNextFile();
+                if (!entry) break;
+                int number = 0;
+                if (sscanf(entry.name(), "tape%d.bin", &number) == 1 && number >= nextTapeNumber) {
+                    nextTapeNumber = number + 1;
+                }
+                entry.close();
+            }
+            dir.close();
+        }
+        Serial.printf("[PUNCH] Ready, next tape: tape%03u\n", nextTapeNumber);
+    }
+
+    // ------------------------------------------------------------------
+    // WIRD VON CPU-TASK (CORE 1) AUFGERUFEN
+    // ------------------------------------------------------------------
+    // false = Punch beschäftigt (Ring voll), ppb wiederholen
+    bool punch(uint8_t tapeByte) {
+        return stall.offer(ring, tapeByte, PUNCH_STALL_MAX_MS);
+    }
+
+    // ------------------------------------------------------------------
+    // CORE 0: Ring leeren (aus loop() aufrufen)
+    // ------------------------------------------------------------------
+    void service() {
+        if (pendingRequest) {
+            pendingRequest = false;
+            if (pendingFinishOnly) {
+                finishTape();
+            } else {
+                newTape(pendingName);
+            }
+        }
+
+        drainRing();
+
+        if (webBufferLen > 0 && millis() - lastWebSend >= PUNCH_WEB_INTERVAL) {
+            flushWeb();
+        }
+
+        // In Pausen auf die Karte schreiben, damit nach Power-Off nichts fehlt
+        if (tapeOpen && fileBufferLen > 0 && millis() - lastPunchTime >= PUNCH_FLUSH_IDLE_MS) {
+            flushFile();
+            tapeFile.flush();
+        }
+    }
+
+    // Neues Tape anlegen (vorheriges wird abgeschlossen). name == nullptr: tapeNNN.
+    // FILE_WRITE kürzt die Datei - ein vorhandenes Tape wird nie überschrieben.
+    bool newTape(const char* name) {
+        if (!sdAvailable) return false;
+
+        char autoName[PUNCH_NAME_MAX + 1];
+        if (name == nullptr || name[0] == 0) {
+            do {
+                snprintf(autoName, sizeof(autoName), "tape%03u", nextTapeNumber++);
+            } while (tapeExists(autoName));
+            name = autoName;
+        } else if (!isValidName(name)) {
+            Serial.printf("[PUNCH] Invalid tape name '%s'\n", name);
+            return false;
+        } else if (tapeExists(name)) {
+            Serial.printf("[PUNCH] Tape %s exists, not overwritten\n", name);
+            return false;
+        }
+        finishTape();
+
+        char path[48];
+        makePath(path, sizeof(path), name);
+        tapeFile = SD.open(path, FILE_WRITE);
+        if (!tapeFile) {
+            Serial.printf("[PUNCH] Error: can't create %s\n", path);
+            return false;
+        }
+
+        strncpy(tapeName, name, PUNCH_NAME_MAX);
+        tapeName[PUNCH_NAME_MAX] = 0;
+        tapeOpen = true;
+        tapeBytes = 0;
+        writeBlank(PUNCH_LEADER_LENGTH);
+        Serial.printf("[PUNCH] New tape: %s\n", path);
+        return true;
+    }
+
+    // Trailer anhängen und Datei schließen - danach per HTTP abrufbar
+    void finishTape() {
+        if (!tapeOpen) return;
+        drainRing();
+        writeBlank(PUNCH_LEADER_LENGTH);
+        flushFile();
+        tapeFile.close();
+        tapeOpen = false;
+        Serial.printf("[PUNCH] Tape %s finished: %lu bytes punched\n", tapeName, (unsigned long)tapeBytes);
+    }
+
+    // Aus anderen Tasks (Webserver): Wechsel wird beim nächsten service() ausgeführt
+    PunchRequest requestNewTape(const char* name) {
+        if (pendingRequest) return PUNCH_REQUEST_BUSY;
+        if (name != nullptr && name[0] != 0) {
+            if (!isValidName(name)) return PUNCH_REQUEST_INVALID;
+            if (tapeExists(name)) return PUNCH_REQUEST_EXISTS;
+        }
+        strncpy(pendingName, name ? name : "", PUNCH_NAME_MAX);
+        pendingName[PUNCH_NAME_MAX] = 0;
+        pendingFinishOnly = false;
+        pendingRequest = true;
+        return PUNCH_REQUEST_OK;
+    }
+
+    bool requestFinishTape() {
+        if (pendingRequest) return false;
+        pendingFinishOnly = true;
+        pendingRequest = true;
+        return true;
+    }
+
+    bool isTapeOpen() const { return tapeOpen; }
+    const char* getTapeName() const { return tapeName; }
+    bool isSDAvailable() const { return sdAvailable; }
+
+    // Aktives Tape darf nicht gestreamt werden (Datei noch offen)
+    bool isFinishedTape(const char* name) const {
+        if (!sdAvailable || !isValidName(name)) return false;
+        if (tapeOpen && strcmp(name, tapeName) == 0) return false;
+        char path[48];
+        makePath(path, sizeof(path), name);
+        return SD.exists(path);
+    }
+
+    static void tapePath(char* path, size_t size, const char* name) {
+        makePath(path, size, name);
+    }
+
+    size_t queueDepth() const { return ring.size(); }
+    uint32_t getOverflows() const { return ring.getOverflows(); }
+
+    void listTapes() {
+        if (!sdAvailable) return;
+        Serial.println("\n=== Punched Tapes ===");
+        File dir = SD.open(PUNCH_DIR);
+        if (dir && dir.isDirectory()) {
+            while (true) {
+                File entry = dir.openNextFile();
+                if (!entry) break;
+                if (!entry.isDirectory()) {
+                    Serial.printf("  %s (%u bytes)%s\n", entry.name(), (unsigned)entry.size(),
+                                  (tapeOpen && strncmp(entry.name(), tapeName, strlen(tapeName)) == 0 &&
+                                   entry.name()[strlen(tapeName)] == '.') ? " [punching]" : "");
+                }
+                entry.close();
+            }
+            dir.close();
+        }
+        Serial.println();
+    }
+};
+
+PunchDevice punchDevice;
+
+#endif // PUNCH_H
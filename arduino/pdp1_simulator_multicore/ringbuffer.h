@@ -0,0 +1,165 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+/*
+LOCK-FREE SPSC RING BUFFER
+Genau ein Producer (z.B. CPU auf Core 1) und genau ein Consumer
+(z.B. Main Loop auf Core 0). Keine Locks, keine Allokation.
+N muss eine Zweierpotenz sein.
+*/
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N must be a power of two");
+
+private:
+    T buffer[N];
+    std::atomic<uint32_t> head{0};       // nur Producer schreibt
+    std::atomic<uint32_t> tail{0};       // nur Consumer schreibt
+    std::atomic<uint32_t> overflows{0};  // verworfene Elemente (Ring voll)
+
+public:
+    // ------------------------------------------------------------------
+    // Producer-Seite
+    // ------------------------------------------------------------------
+    bool push(const T& value) {
+        if (tryPush(value)) return true;
+        countOverflow();
+        return false;
+    }
+
+    // Wie push(), zählt aber keinen Overflow - für Producer, die es
+    // später noch einmal versuchen (siehe RingOutputStall)
+    bool tryPush(const T& value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        buffer[h & (N - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Ein Element endgültig verworfen
+    void countOverflow(uint32_t count = 1) {
+        overflows.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Alles oder nichts - für Einträge, die zusammengehören
+    bool pushAll(const T* values, size_t count) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (N - (h - tail.load(std::memory_order_acquire)) < count) {
+            overflows.fetch_add(count, std::memory_order_relaxed);
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            buffer[(h + i) & (N - 1)] = values[i];
+        }
+        head.store(h + count, std::memory_order_release);
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    // Consumer-Seite
+    // ------------------------------------------------------------------
+    bool pop(T& value) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buffer[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Zusammenhängender lesbarer Bereich ohne Kopie (bis zum Ring-Ende).
+    // Danach consume(n) aufrufen.
+    size_t peek(const T*& data) const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t available = head.load(std::memory_order_acquire) - t;
+        uint32_t index = t & (N - 1);
+        size_t contiguous = N - index;
+        data = &buffer[index];
+        return available < contiguous ? available : contiguous;
+    }
+
+    void consume(size_t count) {
+        tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Kopiert bis zu maxCount Elemente (auch über das Ring-Ende hinweg)
+    size_t popBulk(T* out, size_t maxCount) {
+        size_t total = 0;
+        while (total < maxCount) {
+            const T* data;
+            size_t n = peek(data);
+            if (n == 0) break;
+            if (n > maxCount - total) n = maxCount - total;
+            for (size_t i = 0; i < n; i++) out[total + i] = data[i];
+            consume(n);
+            total += n;
+        }
+        return total;
+    }
+
+    // ------------------------------------------------------------------
+    // Von beiden Seiten lesbar (Momentaufnahme)
+    // ------------------------------------------------------------------
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return N; }
+
+    uint32_t getOverflows() const {
+        return overflows.load(std::memory_order_relaxed);
+    }
+};
+
+// ============================================================================
+// Ausgabegerät am Ring (Punch, Typewriter) - CPU-Seite
+// Ring voll = Gerät beschäftigt. Die CPU schläft dann NICHT unter cpuMutex,
+// offer() liefert false und die IOT wird im nächsten Schritt wiederholt
+// (PDP1::repeatInstruction) - wie eine IOT, die auf den Completion Pulse
+// wartet. Der Mutex ist zwischen den Schritten frei. Erst wenn Core 0
+// maxMs lang nichts abholt, wird das Zeichen verworfen und genau einmal
+// als Overflow gezählt.
+// ============================================================================
+class RingOutputStall {
+private:
+    unsigned long since;
+    bool waiting;
+
+public:
+    RingOutputStall() : since(0), waiting(false) {}
+
+    // true = IOT fertig (geschrieben oder verworfen), false = nochmal versuchen
+    template <typename T, size_t N>
+    bool offer(SpscRing<T, N>& ring, const T& value, unsigned long maxMs) {
+        if (ring.tryPush(value)) {
+            waiting = false;
+            return true;
+        }
+        unsigned long now = millis();
+        if (!waiting) {
+            waiting = true;
+            since = now;
+            return false;
+        }
+        if (now - since < maxMs) return false;
+        waiting = false;
+        ring.countOverflow();
+        return true;
+    }
+
+    bool isWaiting() const { return waiting; }
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,145 @@
+#ifndef TYPEWRITER_H
+#define TYPEWRITER_H
+
+/*
+TYPEWRITER OUTPUT (tyo 730003)
+Core 1 (CPU) schreibt die Zeichen lock-free in einen Ring,
+Core 0 (Main Loop) leert ihn, gibt sie auf Serial aus und schickt sie
+gesammelt alle TYPEWRITER_WEB_INTERVAL ms als eine Nachricht an den Browser.
+Die CPU wartet damit nie auf Serial oder den Netzwerk-Stack.
+
+TYPEWRITER INPUT (tyi 720004)
+Tasten aus Serial ('k', Main Loop) und Browser ("key", AsyncTCP-Task)
+landen in einer Tastatur-FIFO. Zwei Producer: push unter Spinlock,
+die CPU liest lock-free. Program Flag 1 wird nur gesetzt, wenn eine
+Taste ankommt: bei jedem push, und wenn tyi eine Taste abholt und die
+nächste schon wartet. Ein clf 1 des
+Programms bleibt also stehen. Eine Sequence Break gibt es im Simulator
+nicht.
+*/
+
+#include <Arduino.h>
+#include "ringbuffer.h"
+
+#ifdef WEBSERVER_SUPPORT
+    extern void sendTypewriterBatch(const uint8_t* data, size_t len);
+#endif
+
+#define TYPEWRITER_RING_SIZE       1024   // Core 1 -> Core 0
+#define TYPEWRITER_WEB_BUFFER      512
+#define TYPEWRITER_WEB_INTERVAL    33     // ms, wie der Display-Batch
+#define TYPEWRITER_STALL_MAX_MS    50     // voller Ring: so lange bleibt tyo beschäftigt
+#define TYPEWRITER_KEY_FIFO        64     // Tastenanschläge Core 0 -> Core 1
+
+class TypewriterDevice {
+private:
+    SpscRing<uint8_t, TYPEWRITER_RING_SIZE> ring;
+    RingOutputStall stall;
+    SpscRing<uint8_t, TYPEWRITER_KEY_FIFO> keys;
+    portMUX_TYPE keyLock = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<bool> keyArrived{false};    // Flanke für PF1, CPU holt sie ab
+
+    uint8_t webBuffer[TYPEWRITER_WEB_BUFFER];
+    size_t webBufferLen;
+    unsigned long lastWebSend;
+
+    void flushWeb() {
+        #ifdef WEBSERVER_SUPPORT
+            if (webBufferLen > 0) {
+                sendTypewriterBatch(webBuffer, webBufferLen);
+            }
+        #endif
+        webBufferLen = 0;
+        lastWebSend = millis();
+    }
+
+    void appendWeb(const uint8_t* data, size_t len) {
+        #ifdef WEBSERVER_SUPPORT
+            while (len > 0) {
+                size_t n = TYPEWRITER_WEB_BUFFER - webBufferLen;
+                if (n > len) n = len;
+                memcpy(webBuffer + webBufferLen, data, n);
+                webBufferLen += n;
+                data += n;
+                len -= n;
+                if (webBufferLen == TYPEWRITER_WEB_BUFFER) {
+                    flushWeb();
+                }
+            }
+        #endif
+    }
+
+public:
+    TypewriterDevice() {
+        webBufferLen = 0;
+        lastWebSend = 0;
+    }
+
+    // ------------------------------------------------------------------
+    // WIRD VON CPU-TASK (CORE 1) AUFGERUFEN
+    // ------------------------------------------------------------------
+    // false = Schreibmaschine beschäftigt (Ring voll), tyo wiederholen
+    bool type(uint8_t ch) {
+        return stall.offer(ring, ch, TYPEWRITER_STALL_MAX_MS);
+    }
+
+    // ------------------------------------------------------------------
+    // CORE 0: Ring leeren (aus loop() aufrufen)
+    // ------------------------------------------------------------------
+    void service() {
+        const uint8_t* data;
+        size_t n;
+        while ((n = ring.peek(data)) > 0) {
+            Serial.write(data, n);
+            appendWeb(data, n);
+            ring.consume(n);
+        }
+
+        if (webBufferLen > 0 && millis() - lastWebSend >= TYPEWRITER_WEB_INTERVAL) {
+            flushWeb();
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // TASTATUR: Serial (Core 0) und Browser (AsyncTCP-Task)
+    // ------------------------------------------------------------------
+    bool pushKey(uint8_t ch) {
+        portENTER_CRITICAL(&keyLock);
+        bool ok = keys.push(ch);
+        // Jede Taste meldet sich, nicht nur die in die leere FIFO: sonst
+        // kann readKey() auf Core 1 die FIFO gleichzeitig leer sehen und
+        // die Flanke geht verloren. takeKeyArrival() verbraucht sie ohnehin.
+        if (ok) keyArrived.store(true, std::memory_order_release);
+        portEXIT_CRITICAL(&keyLock);
+        return ok;
+    }
+
+    size_t pushKeys(const char* text) {
+        size_t n = 0;
+        while (*text && pushKey((uint8_t)*text++)) n++;
+        return n;
+    }
+
+    // CORE 1
+    bool keyAvailable() const { return !keys.empty(); }
+
+    // Ist seit dem letzten Aufruf eine Taste angekommen? (einmal true)
+    bool takeKeyArrival() {
+        return keyArrived.load(std::memory_order_relaxed) &&
+               keyArrived.exchange(false, std::memory_order_acquire);
+    }
+
+    // Wartet danach schon die nächste Taste, zählt das als neue Ankunft
+    bool readKey(uint8_t& ch) {
+        if (!keys.pop(ch)) return false;
+        if (!keys.empty()) keyArrived.store(true, std::memory_order_release);
+        return true;
+    }
+
+    size_t queueDepth() const { return ring.size(); }
+    uint32_t getOverflows() const { return ring.getOverflows(); }
+};
+
+TypewriterDevice typewriterDevice;
+
+#endif // TYPEWRITER_H
@@ -3,8 +3,8 @@
 
 #include <Arduino.h>
 #include <SPI.h>
-#include <map>
-#include <string>
+#include <atomic>
+#include "esp_timer.h"
 #include "cpu.h"
 
 // Hardware Configuration (falls nicht im Main definiert)
@@ -19,10 +19,19 @@
 #define SW_ROWS   3
 #define COLS      18
 
+#define LED_ROW_TICK_US   1000   // eine Zeile pro Tick: 7 ms pro Durchlauf, ~140 Hz
+#define LED_MUX_PRIORITY  2      // über loop() (1), unter AsyncTCP
+#define LED_TEST_STEP_MS  20     // testPattern(): so lange leuchtet jede LED
+#define SW_SCAN_WAIT      pdMS_TO_TICKS(2)   // max. Warten auf den Multiplexer
+
 // MCP23S17 Instanzen als globale Objekte
 MCP23S17 mcpAddr(MCP_CS_PIN, 0x00, 1000000);    // Decoder + COL16-17
 MCP23S17 mcpColLow(MCP_CS_PIN, 0x01, 1000000);  // COL0-15
 
+// LED-Multiplexer und Schalter-Abfrage teilen sich Decoder und Spalten
+SemaphoreHandle_t matrixMutex = NULL;
+uint32_t switchScansSkipped = 0;   // Multiplexer hielt die Matrix zu lange
+
 void setDecoderAddress(uint8_t addr, bool ledEnable, bool swEnable) {
     uint8_t addrBits = addr & 0x07;
     
@@ -58,142 +67,165 @@ void configureCOLsAsInputs() {
     mcpAddr.setPortPullups(MCP23S17_PORTB, 0xFF);
 }
 
+// ============================================================================
+// LED-Matrix: pro Zeile ein Spaltenwort (Bit n = COLn an)
+// ============================================================================
+// Zeile 0-4: PC, MA, MB, AC, IO - gespiegelt, Registerbit i -> Spalte 17-i
+// Zeile 5:   Status-Lampen (LED_COL_*)
+// Zeile 6:   IR (Bit 13-17 -> Spalte 4-0), Sense Switches 1-6 (Spalte 6-11),
+//            Program Flags 1-6 (Spalte 12-17)
+#define LED_ROW_PC     0
+#define LED_ROW_MA     1
+#define LED_ROW_MB     2
+#define LED_ROW_AC     3
+#define LED_ROW_IO     4
+#define LED_ROW_STATUS 5
+#define LED_ROW_IR     6
+
+#define LED_COL_RUN     0
+#define LED_COL_CYC     1
+#define LED_COL_DF1     2
+#define LED_COL_HSC     3
+#define LED_COL_BC1     4
+#define LED_COL_BC2     5
+#define LED_COL_OV1     6
+#define LED_COL_RIM     7
+#define LED_COL_SBM     8
+#define LED_COL_EXD     9
+#define LED_COL_IOH     10
+#define LED_COL_IOC     11
+#define LED_COL_IOS     12
+#define LED_COL_PWR     15
+#define LED_COL_SSTEP   16
+#define LED_COL_SINSTR  17
+
+#define LED_COL_SS      6      // Sense Switch 1
+#define LED_COL_PF      12     // Program Flag 1
+#define LED_COLS_MASK   0x3FFFF
+
+// 6 Bit spiegeln (Bit i -> Bit 5-i), als Tabelle zur Compile-Zeit
+constexpr uint8_t ledMirror6(uint8_t v) {
+    return ((v & 001) << 5) | ((v & 002) << 3) | ((v & 004) << 1) |
+           ((v & 010) >> 1) | ((v & 020) >> 3) | ((v & 040) >> 5);
+}
+#define LED_M4(n)   ledMirror6(n), ledMirror6(n + 1), ledMirror6(n + 2), ledMirror6(n + 3)
+#define LED_M16(n)  LED_M4(n), LED_M4(n + 4), LED_M4(n + 8), LED_M4(n + 12)
+static constexpr uint8_t LED_MIRROR6[64] = { LED_M16(0), LED_M16(16), LED_M16(32), LED_M16(48) };
+#undef LED_M4
+#undef LED_M16
+
+// 18-Bit-Register -> Spaltenwort: drei Tabellenzugriffe statt 18 Einzel-LEDs
+static constexpr uint32_t ledMirror18(uint32_t v) {
+    return ((uint32_t)LED_MIRROR6[v & 077] << 12) |
+           ((uint32_t)LED_MIRROR6[(v >> 6) & 077] << 6) |
+           LED_MIRROR6[(v >> 12) & 077];
+}
+
+// Prüfungen beim Übersetzen (C++11-constexpr, daher rekursiv):
+// Registerbit i muss auf Spalte 17-i landen - so wie in der alten
+// Namens-Tabelle ("PC<i>" -> COL 17-i) - und nur dort.
+constexpr bool ledMirror6Ok(uint8_t i) {
+    return i == 64 ||
+           (LED_MIRROR6[LED_MIRROR6[i]] == i && ledMirror6Ok(i + 1));
+}
+constexpr bool ledMirror18Ok(uint8_t bit) {
+    return bit == 18 ||
+           (ledMirror18(1UL << bit) == (1UL << (17 - bit)) && ledMirror18Ok(bit + 1));
+}
+static_assert(ledMirror6Ok(0), "LED_MIRROR6 must be its own inverse");
+static_assert(ledMirror18Ok(0), "ledMirror18: register bit i -> column 17-i");
+static_assert(ledMirror18(0777777) == LED_COLS_MASK && ledMirror18(0) == 0, "ledMirror18 range");
+static_assert(ledMirror18(0700000) == 07 && ledMirror18(0000007) == 0700000, "ledMirror18 ends");
+
 class LEDControllerV2 : public ILEDController {
 private:
-    bool ledMatrix[LED_ROWS][COLS];
-    std::map<std::string, std::pair<int, int>> ledNameMap;
+    // Core 1 schreibt (updateDisplay), der LED_Mux-Task auf Core 0 liest:
+    // atomar, relaxed genügt - jede Zeile ist ein eigenes Wort
+    std::atomic<uint32_t> ledRows[LED_ROWS];
     bool showingRandomPattern;
     
-    void initLEDMapping() {
-        // PC (16 Bit) - GESPIEGELT
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "pc%02d", i);
-            ledNameMap[name] = {0, 17 - i};
-        }
-        
-        // MA (16 Bit) - GESPIEGELT
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "ma%02d", i);
-            ledNameMap[name] = {1, 17 - i};
-        }
-        
-        // MB (18 Bit) - GESPIEGELT
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "mb%02d", i);
-            ledNameMap[name] = {2, 17 - i};
-        }
-        
-        // AC (18 Bit) - GESPIEGELT
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "ac%02d", i);
-            ledNameMap[name] = {3, 17 - i};
-        }
-        
-        // IO (18 Bit) - GESPIEGELT
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "io%02d", i);
-            ledNameMap[name] = {4, 17 - i};
-        }
-           
-        
-        ledNameMap["RUN"] = {5, 0};
-        ledNameMap["CYC"] = {5, 1};
-        ledNameMap["Df1"] = {5, 2};
-        ledNameMap["HSC"] = {5, 3};
-        ledNameMap["BC1"] = {5, 4};
-        ledNameMap["BC2"] = {5, 5};
-        ledNameMap["OV1"] = {5, 6};
-        ledNameMap["RIM"] = {5, 7};
-        ledNameMap["SBM"] = {5, 8};
-        ledNameMap["EXD"] = {5, 9};
-        ledNameMap["IOH"] = {5, 10};
-        ledNameMap["IOC"] = {5, 11};
-        ledNameMap["IOS"] = {5, 12};
-        ledNameMap["PWR"] = {5, 15};
-        ledNameMap["SSTEP"] = {5, 16};
-        ledNameMap["SINSTR"] = {5, 17};
-        
-        // IR (5 Bit) - GESPIEGELT
-        for (int i = 0; i < 5; i++) {
-            char name[8];
-            sprintf(name, "ir%02d", i);
-            ledNameMap[name] = {6, 4 - i};
-        }
-        
-        for (int i = 1; i <= 6; i++) {
-            char name[8];
-            sprintf(name, "SS%d", i);
-            ledNameMap[name] = {6, 5 + i};
-        }
-        
-        for (int i = 1; i <= 6; i++) {
-            char name[8];
-            sprintf(name, "PF%d", i);
-            ledNameMap[name] = {6, 11 + i};
+    void setLED(uint8_t row, uint8_t col, bool state) {
+        if (row < LED_ROWS && col < COLS) {
+            if (state) ledRows[row].fetch_or(1UL << col, std::memory_order_relaxed);
+            else ledRows[row].fetch_and(~(1UL << col), std::memory_order_relaxed);
         }
     }
     
-    void setLED(const char* name, bool state) {
-        auto it = ledNameMap.find(name);
-        if (it != ledNameMap.end()) {
-            ledMatrix[it->second.first][it->second.second] = state;
-        }
+    // Multiplexen im Hintergrund: ein Hardware-Timer (esp_timer) weckt
+    // alle LED_ROW_TICK_US den Task, der genau eine Zeile schaltet und
+    // wieder schläft. Die Zeile leuchtet bis zum nächsten Tick - die
+    // LED-Ausgabe wartet nie mit delayMicroseconds(). (Nur die Schalter-
+    // Abfrage in SwitchControllerV2 braucht noch kurze Einschwingzeiten.)
+    esp_timer_handle_t rowTimer;
+    TaskHandle_t muxTask;
+    uint8_t muxRow;
+    std::atomic<uint32_t> skippedRows{0};   // Tick ausgelassen, Schalter wurden gelesen
+    
+    // testPattern(): läuft im Multiplexer mit, statt loop() zu blockieren
+    volatile bool testActive;
+    unsigned long testStart;
+    
+    static void onRowTimer(void* arg) {
+        xTaskNotifyGive(((LEDControllerV2*)arg)->muxTask);
     }
     
-    void setLED(uint8_t row, uint8_t col, bool state) {
-        if (row < LED_ROWS && col < COLS) {
-            ledMatrix[row][col] = state;
+    static void multiplexTask(void* arg) {
+        LEDControllerV2* self = (LEDControllerV2*)arg;
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            self->scanRow();
         }
     }
     
-    void updateLEDMatrix() {
-        for (uint8_t row = 0; row < LED_ROWS; row++) {
-            // Alle Spalten ausschalten
-            mcpColLow.writePort(MCP23S17_PORTA, 0xFF);
-            mcpColLow.writePort(MCP23S17_PORTB, 0xFF);
-            mcpAddr.writePort(MCP23S17_PORTB, 0xFF);
-            
-            delayMicroseconds(10);
-            
-            // Zeile aktivieren
-            setDecoderAddress(row, true, false);
-            
-            delayMicroseconds(5);
-            
-            // Spaltendaten vorbereiten (invertiert: 0 = LED an)
-            uint32_t colData = 0x3FFFF;
-            
-            for (uint8_t col = 0; col < COLS; col++) {
-                if (ledMatrix[row][col]) {
-                    colData &= ~(1 << col);
-                }
-            }
-            
-            // Spaltendaten schreiben
-            mcpColLow.writePort(MCP23S17_PORTA, colData & 0xFF);         // COL0-7
-            mcpColLow.writePort(MCP23S17_PORTB, (colData >> 8) & 0xFF);  // COL8-15
-            
-            uint8_t col16_17 = (colData >> 16) & 0x03;
-            col16_17 = ((col16_17 & 1) << 1) | ((col16_17 & 2) >> 1);  // Swap bit 0 und 1
-            mcpAddr.writePort(MCP23S17_PORTB, col16_17);  // COL16-17
-            
-            delayMicroseconds(400);
+    // Eine Zeile ausgeben. Die SPI-Zugriffe selbst (~25 µs bei 1 MHz)
+    // reichen als Einschwingzeit zwischen Abschalten und neuer Zeile.
+    void scanRow() {
+        // Liest gerade SwitchControllerV2 die Matrix? Dann diesen Tick auslassen
+        if (xSemaphoreTake(matrixMutex, 0) != pdTRUE) {
+            skippedRows.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
         
-        // Alle LEDs ausschalten
+        // Alle Spalten ausschalten
         mcpColLow.writePort(MCP23S17_PORTA, 0xFF);
         mcpColLow.writePort(MCP23S17_PORTB, 0xFF);
         mcpAddr.writePort(MCP23S17_PORTB, 0xFF);
+        
+        // Zeile aktivieren
+        setDecoderAddress(muxRow, true, false);
+        
+        // Spaltendaten (invertiert: 0 = LED an)
+        uint32_t rowBits = testActive ? testPatternRow(muxRow) : ledRows[muxRow].load(std::memory_order_relaxed);
+        uint32_t colData = ~rowBits & LED_COLS_MASK;
+        mcpColLow.writePort(MCP23S17_PORTA, colData & 0xFF);         // COL0-7
+        mcpColLow.writePort(MCP23S17_PORTB, (colData >> 8) & 0xFF);  // COL8-15
+        
+        uint8_t col16_17 = (colData >> 16) & 0x03;
+        col16_17 = ((col16_17 & 1) << 1) | ((col16_17 & 2) >> 1);  // Swap bit 0 und 1
+        mcpAddr.writePort(MCP23S17_PORTB, col16_17);  // COL16-17
+        
+        xSemaphoreGive(matrixMutex);
+        
+        if (++muxRow >= LED_ROWS) {
+            muxRow = 0;
+            metrics.countLedMatrixFrame();   // komplette Durchläufe (7 Zeilen)
+        }
+    }
+    
+    // Lauflicht: jede LED LED_TEST_STEP_MS lang, Zeile für Zeile
+    uint32_t testPatternRow(uint8_t row) {
+        unsigned long index = (millis() - testStart) / LED_TEST_STEP_MS;
+        if (index >= (unsigned long)LED_ROWS * COLS) {
+            testActive = false;
+            LOG_INFO("LED Test finished\n");
+            return ledRows[row].load(std::memory_order_relaxed);
+        }
+        return (index / COLS == row) ? (1UL << (index % COLS)) : 0;
     }
     
 public:
-    LEDControllerV2() {
-        memset(ledMatrix, 0, sizeof(ledMatrix));
+    LEDControllerV2() : rowTimer(nullptr), muxTask(nullptr), muxRow(0), testActive(false), testStart(0) {
+        for (uint8_t row = 0; row < LED_ROWS; row++) ledRows[row].store(0, std::memory_order_relaxed);
         showingRandomPattern = false;
     }
     
@@ -218,8 +250,18 @@ public:
         // Spalten als Ausgänge konfigurieren
         configureCOLsAsOutputs();
         
-        // LED-Mapping initialisieren
-        initLEDMapping();
+        // Multiplex-Task auf Core 0 (über loop(), unter AsyncTCP), Timer starten
+        if (matrixMutex == NULL) matrixMutex = xSemaphoreCreateMutex();
+        xTaskCreatePinnedToCore(multiplexTask, "LED_Mux", 2048, this, LED_MUX_PRIORITY, &muxTask, 0);
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = onRowTimer;
+        timerArgs.arg = this;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.name = "led_mux";
+        if (esp_timer_create(&timerArgs, &rowTimer) != ESP_OK ||
+            esp_timer_start_periodic(rowTimer, LED_ROW_TICK_US) != ESP_OK) {
+            Serial.println("Error: LED multiplex timer not started!");
+        }
         
         Serial.println("LED Controller V2 initialised (PiDP-1 Matrix)");
         Serial.println("  MCP 0x00: Port A=Decoder, Port B=COL16-17");
@@ -241,239 +283,115 @@ public:
             return;
         }
         
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "pc%02d", i);
-            setLED(name, (pc >> i) & 1);
-        }
-        
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "ma%02d", i);
-            setLED(name, (ma >> i) & 1);
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "mb%02d", i);
-            setLED(name, (mb >> i) & 1);
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "ac%02d", i);
-            setLED(name, (ac >> i) & 1);
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "io%02d", i);
-            setLED(name, (io >> i) & 1);
-        }
-        
-        for (int i = 0; i < 5; i++) {
-            char name[8];
-            sprintf(name, "ir%02d", i);
-            setLED(name, (instr >> (13 + i)) & 1);
-        }
-        
-        for (int i = 0; i < 6; i++) {
-            char name[8];
-            sprintf(name, "SS%d", i + 1);
-            setLED(name, (senseSw >> i) & 1);
-        }
-        
-        for (int i = 0; i < 6; i++) {
-            char name[8];
-            sprintf(name, "PF%d", i + 1);
-            setLED(name, (pf >> i) & 1);
-        }
-        
-        setLED("RUN", run);
-        setLED("PWR", power);
-        setLED("SSTEP", step);
-        setLED("OV1", ov);
-        setLED("EXD", extend);  // Extend LED
-        
-        updateLEDMatrix();
+        // Nur die Zeilenwörter setzen - das Multiplexen (SPI) macht
+        // der LED_Mux-Task auf Core 0 mit dem nächsten Timer-Tick
+        ledRows[LED_ROW_PC].store(ledMirror18(pc & 0177777), std::memory_order_relaxed);
+        ledRows[LED_ROW_MA].store(ledMirror18(ma & 0177777), std::memory_order_relaxed);
+        ledRows[LED_ROW_MB].store(ledMirror18(mb), std::memory_order_relaxed);
+        ledRows[LED_ROW_AC].store(ledMirror18(ac), std::memory_order_relaxed);
+        ledRows[LED_ROW_IO].store(ledMirror18(io), std::memory_order_relaxed);
+        ledRows[LED_ROW_STATUS].store(((uint32_t)run << LED_COL_RUN) | ((uint32_t)ov << LED_COL_OV1) |
+                                      ((uint32_t)extend << LED_COL_EXD) | ((uint32_t)power << LED_COL_PWR) |
+                                      ((uint32_t)step << LED_COL_SSTEP), std::memory_order_relaxed);
+        ledRows[LED_ROW_IR].store((LED_MIRROR6[(instr >> 13) & 037] >> 1) |
+                                  ((uint32_t)(senseSw & 077) << LED_COL_SS) |
+                                  ((uint32_t)(pf & 077) << LED_COL_PF), std::memory_order_relaxed);
     }
     
+    // Der nächste Durchlauf schaltet die Spalten ab
     void allOff() override {
-        memset(ledMatrix, 0, sizeof(ledMatrix));
-        mcpColLow.writePort(MCP23S17_PORTA, 0xFF);
-        mcpColLow.writePort(MCP23S17_PORTB, 0xFF);
-        mcpAddr.writePort(MCP23S17_PORTB, 0xFF);
+        for (uint8_t row = 0; row < LED_ROWS; row++) ledRows[row].store(0, std::memory_order_relaxed);
     }
     
+    // Kehrt sofort zurück, der Multiplexer spielt das Lauflicht ab
     void testPattern() override {
         Serial.println("LED Test Pattern V2 ...");
-        
-        for (uint8_t row = 0; row < LED_ROWS; row++) {
-            for (uint8_t col = 0; col < COLS; col++) {
-                setLED(row, col, true);
-                updateLEDMatrix();
-                delay(20);
-                setLED(row, col, false);
-            }
-        }
-        
-        Serial.println("LED Test finished");
+        testStart = millis();
+        testActive = true;
     }
     
     void showRandomPattern() override {
         showingRandomPattern = true;
         
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "pc%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 16; i++) {
-            char name[8];
-            sprintf(name, "ma%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "mb%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "ac%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 18; i++) {
-            char name[8];
-            sprintf(name, "io%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 5; i++) {
-            char name[8];
-            sprintf(name, "ir%02d", i);
-            setLED(name, random(0, 2));
-        }
-        
-        for (int i = 0; i < 6; i++) {
-            char name[8];
-            sprintf(name, "PF%d", i + 1);
-            setLED(name, random(0, 2));
-        }
-        
-        setLED("PWR", true);
-        setLED("RUN", false);
-        setLED("SSTEP", false);
-        setLED("OV1", random(0, 2));
+        ledRows[LED_ROW_PC].store(random(0, 0200000) << 2, std::memory_order_relaxed);
+        ledRows[LED_ROW_MA].store(random(0, 0200000) << 2, std::memory_order_relaxed);
+        ledRows[LED_ROW_MB].store(random(0, 01000000), std::memory_order_relaxed);
+        ledRows[LED_ROW_AC].store(random(0, 01000000), std::memory_order_relaxed);
+        ledRows[LED_ROW_IO].store(random(0, 01000000), std::memory_order_relaxed);
+        ledRows[LED_ROW_STATUS].store((1UL << LED_COL_PWR) | ((uint32_t)random(0, 2) << LED_COL_OV1),
+                                      std::memory_order_relaxed);
+        // IR und Program Flags zufällig, Sense Switches bleiben
+        uint32_t sense = ledRows[LED_ROW_IR].load(std::memory_order_relaxed) & (077UL << LED_COL_SS);
+        ledRows[LED_ROW_IR].store(sense | random(0, 040) | ((uint32_t)random(0, 0100) << LED_COL_PF),
+                                  std::memory_order_relaxed);
     }
     
     void clearRandomPattern() override {
         showingRandomPattern = false;
     }
     
-    void refresh() override {
-        updateLEDMatrix();
+    void printStats() {
+        static unsigned long lastTime = 0;
+        static uint32_t lastFrames = 0;
+        unsigned long now = millis();
+        uint32_t f = getFrames();
+        if (lastTime > 0 && now > lastTime) {
+            Serial.printf("LED Matrix: %lu Hz, %lu rows skipped (switch scan), %lu switch scans skipped\n",
+                          (unsigned long)((f - lastFrames) * 1000UL / (now - lastTime)),
+                          (unsigned long)skippedRows.load(std::memory_order_relaxed),
+                          (unsigned long)switchScansSkipped);
+        }
+        lastTime = now;
+        lastFrames = f;
     }
     
-    void forceRefresh() {
-        updateLEDMatrix();
-    }
+    // Komplette Matrix-Durchläufe seit Start (/metrics)
+    uint32_t getFrames() const { return metrics.ledMatrixFrames.load(std::memory_order_relaxed); }
+};
+
+// Schalter-Namen -> Position in der Matrix (Reihe, Spalte)
+struct SwitchPosition {
+    const char* name;
+    uint8_t row;
+    uint8_t col;
+};
+
+static constexpr SwitchPosition SWITCH_POSITIONS[] = {
+    { "EXT", 0, 0 },  { "PWR", 0, 1 },
+    
+    // Adress-Schalter TA02..TA16 -> Spalte 17..3
+    { "TA02", 0, 17 }, { "TA03", 0, 16 }, { "TA04", 0, 15 },
+    { "TA05", 0, 14 }, { "TA06", 0, 13 }, { "TA07", 0, 12 },
+    { "TA08", 0, 11 }, { "TA09", 0, 10 }, { "TA10", 0, 9 },
+    { "TA11", 0, 8 },  { "TA12", 0, 7 },  { "TA13", 0, 6 },
+    { "TA14", 0, 5 },  { "TA15", 0, 4 },  { "TA16", 0, 3 },
+    
+    // Test Word TW00..TW17 -> Spalte 17..0
+    { "TW00", 1, 17 }, { "TW01", 1, 16 }, { "TW02", 1, 15 },
+    { "TW03", 1, 14 }, { "TW04", 1, 13 }, { "TW05", 1, 12 },
+    { "TW06", 1, 11 }, { "TW07", 1, 10 }, { "TW08", 1, 9 },
+    { "TW09", 1, 8 },  { "TW10", 1, 7 },  { "TW11", 1, 6 },
+    { "TW12", 1, 5 },  { "TW13", 1, 4 },  { "TW14", 1, 3 },
+    { "TW15", 1, 2 },  { "TW16", 1, 1 },  { "TW17", 1, 0 },
+    
+    { "SSTEP", 2, 0 }, { "SINST", 2, 1 },
+    { "SW1", 2, 2 }, { "SW2", 2, 3 }, { "SW3", 2, 4 },
+    { "SW4", 2, 5 }, { "SW5", 2, 6 }, { "SW6", 2, 7 },
+    { "START1", 2, 8 },   { "START2", 2, 9 },   { "STOP", 2, 10 },
+    { "CONT", 2, 11 },    { "EXAMINE", 2, 12 }, { "DEPOSIT", 2, 13 },
+    { "READIN", 2, 14 },  { "READER1", 2, 15 }, { "READER2", 2, 16 },
+    { "FEED", 2, 17 },
 };
 
 class SwitchControllerV2 : public ISwitchController {
 private:
     bool switchMatrix[SW_ROWS][COLS];
-    std::map<std::string, std::pair<int, int>> switchNameMap;
-    
-    void initSwitchMapping() {
-        switchNameMap["EXT"] = {0, 0};
-        switchNameMap["PWR"] = {0, 1};
-        // for (int i = 2; i <= 17; i++) {
-        //     char name[8];
-        //     sprintf(name, "TA%02d", 15 - i);
-        //     switchNameMap[name] = {0, i};
-        // }
-        
-        switchNameMap["TA02"] = { 0, 17 };
-        switchNameMap["TA03"] = { 0, 16 };
-        switchNameMap["TA04"] = { 0, 15 };
-        
-        switchNameMap["TA05"] = { 0, 14 };
-        switchNameMap["TA06"] = { 0, 13 };
-        switchNameMap["TA07"] = { 0, 12 };
-        
-        switchNameMap["TA08"] = { 0, 11 };
-        switchNameMap["TA09"] = { 0, 10 };
-        switchNameMap["TA10"] = { 0, 9 };
-        
-        switchNameMap["TA11"] = { 0, 8 };
-        switchNameMap["TA12"] = { 0, 7 };
-        switchNameMap["TA13"] = { 0, 6 };
-        
-        switchNameMap["TA14"] = { 0, 5 };
-        switchNameMap["TA15"] = { 0, 4 };
-        switchNameMap["TA16"] = { 0, 3 };
-        
-
-
-        switchNameMap["TW00"] = { 1, 17 };
-        switchNameMap["TW01"] = { 1, 16 };
-        switchNameMap["TW02"] = { 1, 15 };
-        
-        switchNameMap["TW03"] = { 1, 14 };
-        switchNameMap["TW04"] = { 1, 13 };
-        switchNameMap["TW05"] = { 1, 12 };
-        
-        switchNameMap["TW06"] = { 1, 11 };
-        switchNameMap["TW07"] = { 1, 10 };
-        switchNameMap["TW08"] = { 1, 9 };
-        
-        switchNameMap["TW09"] = { 1, 8 };
-        switchNameMap["TW10"] = { 1, 7 };
-        switchNameMap["TW11"] = { 1, 6 };
-        
-        switchNameMap["TW12"] = { 1, 5 };
-        switchNameMap["TW13"] = { 1, 4 };
-        switchNameMap["TW14"] = { 1, 3 };
-        
-        switchNameMap["TW15"] = { 1, 2 };
-        switchNameMap["TW16"] = { 1, 1 };
-        switchNameMap["TW17"] = { 1, 0 };
-        
-
-        // for (int i = 0; i <= 17; i++) {
-        //     char name[8];
-        //     sprintf(name, "TW%02d", 17 - i);
-        //     switchNameMap[name] = {1, i};
-        // }
-        
-        switchNameMap["SSTEP"] = {2, 0};
-        switchNameMap["SINST"] = {2, 1};
-        for (int i = 1; i <= 6; i++) {
-            char name[8];
-            sprintf(name, "SW%d", i);
-            switchNameMap[name] = {2, i + 1};
-        }
-        switchNameMap["START1"] = {2, 8};
-        switchNameMap["START2"] = {2, 9};
-        switchNameMap["STOP"] = {2, 10};
-        switchNameMap["CONT"] = {2, 11};
-        switchNameMap["EXAMINE"] = {2, 12};
-        switchNameMap["DEPOSIT"] = {2, 13};
-        switchNameMap["READIN"] = {2, 14};
-        switchNameMap["READER1"] = {2, 15};
-        switchNameMap["READER2"] = {2, 16};
-        switchNameMap["FEED"] = {2, 17};
-    }
     
     bool getSwitch(const char* name) {
-        auto it = switchNameMap.find(name);
-        if (it != switchNameMap.end()) {
-            return switchMatrix[it->second.first][it->second.second];
+        for (const SwitchPosition& sw : SWITCH_POSITIONS) {
+            if (strcmp(sw.name, name) == 0) {
+                return switchMatrix[sw.row][sw.col];
+            }
         }
         return false;
     }
@@ -484,11 +402,17 @@ public:
     }
     
     void begin() override {
-        initSwitchMapping();
         Serial.println("Switch Controller V2 initialised (PiDP-1 Matrix)");
     }
     
+    // Läuft unter cpuMutex (handleSwitches): nie unbegrenzt auf den
+    // Multiplexer warten. Ist die Matrix nach SW_SCAN_WAIT noch belegt,
+    // bleibt der letzte Schalterstand stehen.
     void update() override {
+        if (matrixMutex && xSemaphoreTake(matrixMutex, SW_SCAN_WAIT) != pdTRUE) {
+            switchScansSkipped++;
+            return;
+        }
         configureCOLsAsInputs();
         delayMicroseconds(50);
         
@@ -517,6 +441,7 @@ public:
         mcpColLow.writePort(MCP23S17_PORTA, 0xFF);
         mcpColLow.writePort(MCP23S17_PORTB, 0xFF);
         mcpAddr.writePort(MCP23S17_PORTB, 0xFF);
+        if (matrixMutex) xSemaphoreGive(matrixMutex);
     }
     
     uint16_t getAddressSwitches() override {
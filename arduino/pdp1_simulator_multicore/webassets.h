@@ -0,0 +1,221 @@
+#ifndef WEBASSETS_H
+#define WEBASSETS_H
+
+/*
+WEB ASSET CACHE - Web-Oberfläche einmal beim Start in den RAM laden
+Die Dateien aus /web/ werden beim Booten von der SD-Karte gelesen (PSRAM,
+sonst Heap) und danach nur noch aus dem RAM ausgeliefert - keine SD-Zugriffe
+über den langsamen SPI-Bus mehr, während die CPU läuft.
+
+Liegt neben einer Datei eine gzip-Version (index.html.gz, erzeugt mit
+tools/gzip_web.py), wird nur diese geladen und mit Content-Encoding: gzip
+geschickt - außer das Original ist neuer (vergessen neu zu packen).
+Jede Datei bekommt ein ETag (FNV-1a über den Inhalt); der Browser fragt
+mit If-None-Match nach und bekommt 304, solange sich nichts ändert.
+
+Was nicht in den Cache passt, liefert serveStatic() weiter von der SD-Karte.
+*/
+
+#include <Arduino.h>
+#include <SD.h>
+#include <ESPAsyncWebServer.h>
+
+#define WEB_ASSET_DIR          "/web"
+#define WEB_ASSET_MAX_FILES    16
+#define WEB_ASSET_MAX_BYTES    (256 * 1024)   // mit PSRAM
+#define WEB_ASSET_MAX_HEAP     (64 * 1024)    // ohne PSRAM
+#define WEB_ASSET_NAME_LEN     32
+
+struct WebAsset {
+    char path[WEB_ASSET_NAME_LEN + 2];   // "/index.html"
+    const char* contentType;
+    uint8_t* data;
+    size_t size;
+    bool gzip;
+    char etag[12];                       // "\"xxxxxxxx\""
+};
+
+class WebAssetCache {
+private:
+    WebAsset assets[WEB_ASSET_MAX_FILES];
+    size_t count;
+    size_t bytes;
+    uint32_t hits;
+    uint32_t notModified;
+
+    static const char* contentTypeFor(const char* name) {
+        const char* ext = strrchr(name, '.');
+        if (ext == nullptr) return "application/octet-stream";
+        if (strcmp(ext, ".html") == 0) return "text/html";
+        if (strcmp(ext, ".js") == 0) return "application/javascript";
+        if (strcmp(ext, ".css") == 0) return "text/css";
+        if (strcmp(ext, ".json") == 0) return "application/json";
+        if (strcmp(ext, ".png") == 0) return "image/png";
+        if (strcmp(ext, ".svg") == 0) return "image/svg+xml";
+        if (strcmp(ext, ".ico") == 0) return "image/x-icon";
+        return "application/octet-stream";
+    }
+
+    static uint32_t fnv1a(const uint8_t* data, size_t len) {
+        uint32_t hash = 2166136261UL;
+        for (size_t i = 0; i < len; i++) {
+            hash ^= data[i];
+            hash *= 16777619UL;
+        }
+        return hash;
+    }
+
+    static bool endsWith(const char* name, const char* suffix) {
+        size_t n = strlen(name);
+        size_t m = strlen(suffix);
+        return n >= m && strcmp(name + n - m, suffix) == 0;
+    }
+
+    WebAsset* find(const char* path) {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(assets[i].path, path) == 0) return &assets[i];
+        }
+        return nullptr;
+    }
+
+    // Eine Datei laden; name ohne ".gz"
+    bool load(const char* name, bool gzip) {
+        if (count >= WEB_ASSET_MAX_FILES || strlen(name) > WEB_ASSET_NAME_LEN) return false;
+
+        char file[WEB_ASSET_NAME_LEN + 16];
+        snprintf(file, sizeof(file), "%s/%s%s", WEB_ASSET_DIR, name, gzip ? ".gz" : "");
+        File f = SD.open(file, FILE_READ);
+        if (!f) return false;
+
+        size_t size = f.size();
+        size_t limit = psramFound() ? WEB_ASSET_MAX_BYTES : WEB_ASSET_MAX_HEAP;
+        if (size == 0 || bytes + size > limit) {
+            Serial.printf("[ASSETS] %s (%u bytes) does not fit, served from SD\n", file, (unsigned)size);
+            f.close();
+            return false;
+        }
+        uint8_t* data = (uint8_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+        if (data == nullptr) {
+            f.close();
+            return false;
+        }
+        size_t got = f.read(data, size);
+        f.close();
+        if (got != size) {
+            free(data);
+            return false;
+        }
+
+        WebAsset& a = assets[count++];
+        snprintf(a.path, sizeof(a.path), "/%s", name);
+        a.contentType = contentTypeFor(name);
+        a.data = data;
+        a.size = size;
+        a.gzip = gzip;
+        snprintf(a.etag, sizeof(a.etag), "\"%08lx\"", (unsigned long)fnv1a(data, size));
+        bytes += size;
+        return true;
+    }
+
+    // Original nach der .gz-Datei geändert? Dann lieber das Original
+    static bool isStale(const char* name) {
+        char file[WEB_ASSET_NAME_LEN + 16];
+        snprintf(file, sizeof(file), "%s/%s", WEB_ASSET_DIR, name);
+        if (!SD.exists(file)) return false;
+        File original = SD.open(file, FILE_READ);
+        time_t originalTime = original.getLastWrite();
+        original.close();
+        strcat(file, ".gz");
+        File packed = SD.open(file, FILE_READ);
+        time_t packedTime = packed.getLastWrite();
+        packed.close();
+        return originalTime > packedTime;
+    }
+
+public:
+    WebAssetCache() : count(0), bytes(0), hits(0), notModified(0) {
+        memset(assets, 0, sizeof(assets));
+    }
+
+    // Beim Start, vor server.begin(): alle Dateien aus /web/ laden
+    void begin() {
+        unsigned long start = millis();
+        File dir = SD.open(WEB_ASSET_DIR);
+        if (!dir || !dir.isDirectory()) {
+            Serial.println("[ASSETS] No /web directory on SD card");
+            return;
+        }
+
+        // Erst die .gz-Dateien, dann die übrigen ohne gz-Version
+        for (int pass = 0; pass < 2; pass++) {
+            dir.rewindDirectory();
+            while (true) {
+                File entry = dir.openNextFile();
+                if (!entry) break;
+                char name[WEB_ASSET_NAME_LEN + 4];
+                strncpy(name, entry.name(), sizeof(name) - 1);
+                name[sizeof(name) - 1] = 0;
+                bool isDir = entry.isDirectory();
+                entry.close();
+                if (isDir) continue;
+
+                bool gzip = endsWith(name, ".gz");
+                if (gzip != (pass == 0)) continue;
+                if (gzip) name[strlen(name) - 3] = 0;
+                char path[WEB_ASSET_NAME_LEN + 8];
+                snprintf(path, sizeof(path), "/%s", name);
+                if (find(path) != nullptr) continue;   // gz-Version schon geladen
+                if (gzip && isStale(name)) {
+                    Serial.printf("[ASSETS] %s.gz is older than %s - run tools/gzip_web.py\n", name, name);
+                    continue;
+                }
+                load(name, gzip);
+            }
+        }
+        dir.close();
+
+        Serial.printf("[ASSETS] %u files, %u bytes cached in %lu ms\n",
+                      (unsigned)count, (unsigned)bytes, millis() - start);
+    }
+
+    // Für jede Datei einen Handler registrieren (und "/" für index.html)
+    void registerRoutes(AsyncWebServer& server) {
+        for (size_t i = 0; i < count; i++) {
+            WebAsset* asset = &assets[i];
+            ArRequestHandlerFunction handler = [this, asset](AsyncWebServerRequest *request) {
+                send(request, *asset);
+            };
+            server.on(asset->path, HTTP_GET, handler);
+            if (strcmp(asset->path, "/index.html") == 0) {
+                server.on("/", HTTP_GET, handler);
+            }
+        }
+    }
+
+    void send(AsyncWebServerRequest* request, const WebAsset& asset) {
+        hits++;
+        if (request->hasHeader("If-None-Match") &&
+            request->header("If-None-Match") == asset.etag) {
+            notModified++;
+            AsyncWebServerResponse* response = request->beginResponse(304, asset.contentType, "");
+            response->addHeader("ETag", asset.etag);
+            request->send(response);
+            return;
+        }
+        // Daten bleiben im Cache, die Antwort liest direkt daraus
+        AsyncWebServerResponse* response = request->beginResponse(200, asset.contentType, asset.data, asset.size);
+        if (asset.gzip) response->addHeader("Content-Encoding", "gzip");
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", "no-cache");   // immer mit ETag nachfragen
+        request->send(response);
+    }
+
+    void printStats() {
+        Serial.printf("Web assets: %u files, %u bytes in RAM, %lu requests (%lu not modified)\n",
+                      (unsigned)count, (unsigned)bytes, (unsigned long)hits, (unsigned long)notModified);
+    }
+};
+
+WebAssetCache webAssets;
+
+#endif // WEBASSETS_H
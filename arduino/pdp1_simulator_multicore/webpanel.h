@@ -0,0 +1,363 @@
+#ifndef WEBPANEL_H
+#define WEBPANEL_H
+
+/*
+WEB FRONT PANEL - Lampen und Schalter im Browser (panel.html)
+WebLEDController und WebSwitchController sitzen vor den Hardware-Controllern
+(V1/V2) oder ersetzen sie (WEB_PANEL_ONLY, Board ohne Panel):
+
+  WebLEDController     reicht alles an die Hardware weiter und merkt sich
+                       die Registerwerte (Core 1, ~60 Hz)
+  WebSwitchController  Hardware-Schalter ODER Browser-Schalter; Tasten aus
+                       dem Browser gelten genau einen handleSwitches()-Durchlauf
+
+Core 0 schickt höchstens alle PANEL_FRAME_MS ms jedem Panel-Client nur die
+Register, die sich seit seinem letzten Frame geändert haben. Ein Client mit
+voller Queue wird übersprungen, sein Diff bleibt offen und geht im nächsten
+Frame mit.
+
+Nachricht (binär, Typ 0x04):
+  Byte 0     WS_FRAME_PANEL
+  Byte 1-2   Maske der enthaltenen Register (little-endian, Bit n = Register n)
+  je Register: Wert, 3 Byte little-endian
+*/
+
+#include <Arduino.h>
+
+#define WS_FRAME_PANEL        0x04
+#define PANEL_FRAME_MS        16      // max. ~60 Frames/s
+#define PANEL_MAX_CLIENTS     4
+#define PANEL_FRAME_MAX       (3 + PANEL_REGS * 3)
+
+// Register im Lampen-Frame
+enum PanelRegister : uint8_t {
+    PANEL_PC = 0,
+    PANEL_MA,
+    PANEL_MB,
+    PANEL_AC,
+    PANEL_IO,
+    PANEL_INSTR,
+    PANEL_FLAGS,        // Program Flags Bits 0-5, Sense Switches Bits 6-11
+    PANEL_STATUS,       // PANEL_LAMP_*
+    PANEL_SW_ADDRESS,   // Schalterstellung (Hardware ODER Browser)
+    PANEL_SW_TESTWORD,
+    PANEL_SW_TOGGLES,   // Sense Switches Bits 0-5, PANEL_TOGGLE_*
+    PANEL_REGS
+};
+
+#define PANEL_LAMP_OV        0x01
+#define PANEL_LAMP_POWER     0x02
+#define PANEL_LAMP_RUN       0x04
+#define PANEL_LAMP_STEP      0x08
+#define PANEL_LAMP_EXTEND    0x10
+
+#define PANEL_TOGGLE_EXTEND  0x040
+#define PANEL_TOGGLE_POWER   0x080
+#define PANEL_TOGGLE_SSTEP   0x100
+#define PANEL_TOGGLE_SINST   0x200
+
+#define PANEL_BUTTON_START     0x01   // Start (unten)
+#define PANEL_BUTTON_START_UP  0x02   // Start von den Adressschaltern
+#define PANEL_BUTTON_STOP      0x04
+#define PANEL_BUTTON_CONTINUE  0x08
+#define PANEL_BUTTON_EXAMINE   0x10
+#define PANEL_BUTTON_DEPOSIT   0x20
+#define PANEL_BUTTON_READIN    0x40
+
+static uint8_t panelButtonFromName(const char* name) {
+    if (name == nullptr) return 0;
+    if (strcmp(name, "start") == 0) return PANEL_BUTTON_START;
+    if (strcmp(name, "start_up") == 0) return PANEL_BUTTON_START_UP;
+    if (strcmp(name, "stop") == 0) return PANEL_BUTTON_STOP;
+    if (strcmp(name, "continue") == 0) return PANEL_BUTTON_CONTINUE;
+    if (strcmp(name, "examine") == 0) return PANEL_BUTTON_EXAMINE;
+    if (strcmp(name, "deposit") == 0) return PANEL_BUTTON_DEPOSIT;
+    if (strcmp(name, "readin") == 0) return PANEL_BUTTON_READIN;
+    return 0;
+}
+
+struct PanelClient {
+    uint32_t id;            // 0 = frei
+    bool valid;             // last[] gilt, sonst volles Bild senden
+    uint32_t last[PANEL_REGS];
+    uint32_t framesSent;
+    uint32_t framesSkipped; // Queue voll
+};
+
+// Gemeinsamer Zustand zwischen CPU-Task, loop() und AsyncTCP-Task
+class WebPanel {
+private:
+    uint32_t regs[PANEL_REGS];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Vom Browser gesetzt (AsyncTCP-Task), Wortzugriffe
+    volatile uint32_t webAddress;
+    volatile uint32_t webTestWord;
+    volatile uint32_t webToggles;
+    volatile uint32_t webButtons;
+
+    PanelClient clients[PANEL_MAX_CLIENTS];
+    SemaphoreHandle_t clientsMutex;
+
+public:
+    WebPanel() : webAddress(0), webTestWord(0), webToggles(0), webButtons(0),
+                 clientsMutex(NULL) {
+        memset(regs, 0, sizeof(regs));
+        memset(clients, 0, sizeof(clients));
+    }
+
+    void begin() {
+        clientsMutex = xSemaphoreCreateMutex();
+        if (clientsMutex == NULL) {
+            Serial.println("[PANEL] Error: Panel-Clients-Mutex!");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Lampen (WebLEDController, Core 1 und handleSwitches auf Core 0)
+    // ------------------------------------------------------------------
+    void setLamps(const uint32_t* values, size_t first, size_t count) {
+        portENTER_CRITICAL(&lock);
+        memcpy(&regs[first], values, count * sizeof(uint32_t));
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void snapshot(uint32_t* out) {
+        portENTER_CRITICAL(&lock);
+        memcpy(out, regs, sizeof(regs));
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // ------------------------------------------------------------------
+    // Schalter aus dem Browser
+    // ------------------------------------------------------------------
+    void setAddress(uint32_t value)  { webAddress = value & 0177777; }
+    void setTestWord(uint32_t value) { webTestWord = value & 0777777; }
+    void setToggles(uint32_t value)  { webToggles = value & 01777; }
+    // Einen Schalter umlegen (row: "address", "testword", "toggles")
+    void flipSwitch(const char* row, uint8_t bit) {
+        if (row == nullptr || bit > 17) return;
+        if (strcmp(row, "address") == 0) setAddress(webAddress ^ (1UL << bit));
+        else if (strcmp(row, "testword") == 0) setTestWord(webTestWord ^ (1UL << bit));
+        else if (strcmp(row, "toggles") == 0) setToggles(webToggles ^ (1UL << bit));
+    }
+
+    void pressButtons(uint32_t mask) {
+        portENTER_CRITICAL(&lock);
+        webButtons |= mask;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    uint32_t getAddress() const  { return webAddress; }
+    uint32_t getTestWord() const { return webTestWord; }
+    uint32_t getToggles() const  { return webToggles; }
+
+    // Gedrückte Tasten abholen (einmal pro handleSwitches)
+    uint32_t takeButtons() {
+        portENTER_CRITICAL(&lock);
+        uint32_t mask = webButtons;
+        webButtons = 0;
+        portEXIT_CRITICAL(&lock);
+        return mask;
+    }
+
+    // ------------------------------------------------------------------
+    // Panel-Clients (AsyncTCP: connect/disconnect, loop: send)
+    // ------------------------------------------------------------------
+    bool lockClients(TickType_t wait) {
+        return clientsMutex != NULL && xSemaphoreTake(clientsMutex, wait) == pdTRUE;
+    }
+    void unlockClients() { xSemaphoreGive(clientsMutex); }
+
+    // Mit lockClients()
+    bool add(uint32_t id) {
+        PanelClient* free = nullptr;
+        for (auto& c : clients) {
+            if (c.id == id) { c.valid = false; return true; }
+            if (c.id == 0 && free == nullptr) free = &c;
+        }
+        if (free == nullptr) return false;
+        memset(free, 0, sizeof(*free));
+        free->id = id;
+        return true;
+    }
+
+    bool remove(uint32_t id) {
+        for (auto& c : clients) {
+            if (c.id == id) { c.id = 0; return true; }
+        }
+        return false;
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        for (const auto& c : clients) if (c.id != 0) n++;
+        return n;
+    }
+
+    PanelClient* client(size_t i) { return clients[i].id ? &clients[i] : nullptr; }
+
+    // Diff gegen den letzten Frame des Clients, 0 = nichts geändert
+    static size_t encodeDiff(PanelClient& c, const uint32_t* now, uint8_t* out) {
+        uint16_t mask = 0;
+        size_t len = 3;
+        for (int r = 0; r < PANEL_REGS; r++) {
+            if (c.valid && c.last[r] == now[r]) continue;
+            mask |= 1 << r;
+            out[len++] = now[r] & 0xFF;
+            out[len++] = (now[r] >> 8) & 0xFF;
+            out[len++] = (now[r] >> 16) & 0xFF;
+            c.last[r] = now[r];
+        }
+        if (mask == 0) return 0;
+        c.valid = true;
+        out[0] = WS_FRAME_PANEL;
+        out[1] = mask & 0xFF;
+        out[2] = mask >> 8;
+        return len;
+    }
+};
+
+WebPanel webPanel;
+
+// ============================================================================
+// LED CONTROLLER: Hardware (optional) + Lampen-Zustand für den Browser
+// ============================================================================
+class WebLEDController : public ILEDController {
+private:
+    ILEDController* hardware;   // nullptr = kein Panel angeschlossen
+
+public:
+    explicit WebLEDController(ILEDController* hw) : hardware(hw) {}
+
+    void begin() override {
+        if (hardware) hardware->begin();
+        Serial.printf("Web Panel LEDs initialised (%s)\n", hardware ? "with hardware" : "headless");
+    }
+
+    void updateDisplay(uint32_t ac, uint32_t io, uint16_t pc, uint16_t ma,
+                       uint32_t mb, uint32_t instr, bool ov, uint8_t pf,
+                       uint8_t senseSw, bool power, bool run, bool step,
+                       bool extend = false) override {
+        if (hardware) {
+            hardware->updateDisplay(ac, io, pc, ma, mb, instr, ov, pf, senseSw,
+                                    power, run, step, extend);
+        }
+        uint32_t lamps[PANEL_STATUS + 1];
+        lamps[PANEL_PC] = pc;
+        lamps[PANEL_MA] = ma;
+        lamps[PANEL_MB] = mb;
+        lamps[PANEL_AC] = ac;
+        lamps[PANEL_IO] = io;
+        lamps[PANEL_INSTR] = instr;
+        lamps[PANEL_FLAGS] = (pf & 077) | ((senseSw & 077) << 6);
+        lamps[PANEL_STATUS] = (ov ? PANEL_LAMP_OV : 0) | (power ? PANEL_LAMP_POWER : 0) |
+                              (run ? PANEL_LAMP_RUN : 0) | (step ? PANEL_LAMP_STEP : 0) |
+                              (extend ? PANEL_LAMP_EXTEND : 0);
+        webPanel.setLamps(lamps, 0, PANEL_STATUS + 1);
+    }
+
+    void allOff() override {
+        if (hardware) hardware->allOff();
+        uint32_t lamps[PANEL_STATUS + 1] = {0};
+        webPanel.setLamps(lamps, 0, PANEL_STATUS + 1);
+    }
+
+    void testPattern() override {
+        if (hardware) hardware->testPattern();
+        uint32_t lamps[PANEL_STATUS + 1];
+        for (auto& v : lamps) v = 0777777;
+        webPanel.setLamps(lamps, 0, PANEL_STATUS + 1);
+    }
+
+    void showRandomPattern() override  { if (hardware) hardware->showRandomPattern(); }
+    void clearRandomPattern() override { if (hardware) hardware->clearRandomPattern(); }
+    void refresh() override            { if (hardware) hardware->refresh(); }
+};
+
+// ============================================================================
+// SWITCH CONTROLLER: Hardware-Schalter (optional) ODER Browser-Schalter
+// ============================================================================
+class WebSwitchController : public ISwitchController {
+private:
+    ISwitchController* hardware;   // nullptr = kein Panel angeschlossen
+    volatile uint32_t buttons;     // Browser-Tasten dieses Durchlaufs
+
+    bool hw(bool (ISwitchController::*get)()) {
+        return hardware && (hardware->*get)();
+    }
+    bool toggle(uint32_t bit) const  { return webPanel.getToggles() & bit; }
+    bool button(uint32_t bit) const  { return buttons & bit; }
+
+public:
+    explicit WebSwitchController(ISwitchController* hw) : hardware(hw), buttons(0) {}
+
+    void begin() override {
+        if (hardware) {
+            hardware->begin();
+        } else {
+            // Headless: Power steht auf an, sonst läuft nichts
+            webPanel.setToggles(PANEL_TOGGLE_POWER);
+        }
+        Serial.printf("Web Panel switches initialised (%s)\n", hardware ? "with hardware" : "headless");
+    }
+
+    void update() override {
+        if (hardware) hardware->update();
+        buttons = webPanel.takeButtons();
+
+        uint32_t echo[3] = {
+            getAddressSwitches(),
+            getTestWord(),
+            (uint32_t)getSenseSwitches() |
+                (getExtendSwitch() ? PANEL_TOGGLE_EXTEND : 0) |
+                (getPower() ? PANEL_TOGGLE_POWER : 0) |
+                (getSingleStep() ? PANEL_TOGGLE_SSTEP : 0) |
+                (getSingleInstr() ? PANEL_TOGGLE_SINST : 0)
+        };
+        webPanel.setLamps(echo, PANEL_SW_ADDRESS, 3);
+    }
+
+    uint16_t getAddressSwitches() override {
+        return (hardware ? hardware->getAddressSwitches() : 0) | webPanel.getAddress();
+    }
+    uint32_t getTestWord() override {
+        return ((hardware ? hardware->getTestWord() : 0) | webPanel.getTestWord()) & WORD_MASK;
+    }
+    uint8_t getSenseSwitches() override {
+        return (hardware ? hardware->getSenseSwitches() : 0) | (webPanel.getToggles() & 077);
+    }
+
+    bool getExtendSwitch() override { return hw(&ISwitchController::getExtendSwitch) || toggle(PANEL_TOGGLE_EXTEND); }
+    bool getPower() override        { return hw(&ISwitchController::getPower) || toggle(PANEL_TOGGLE_POWER); }
+    bool getSingleStep() override   { return hw(&ISwitchController::getSingleStep) || toggle(PANEL_TOGGLE_SSTEP); }
+    bool getSingleInstr() override  { return hw(&ISwitchController::getSingleInstr) || toggle(PANEL_TOGGLE_SINST); }
+
+    bool getStartDown() override { return hw(&ISwitchController::getStartDown) || button(PANEL_BUTTON_START); }
+    bool getStartUp() override   { return hw(&ISwitchController::getStartUp) || button(PANEL_BUTTON_START_UP); }
+    bool getStop() override      { return hw(&ISwitchController::getStop) || button(PANEL_BUTTON_STOP); }
+    bool getContinue() override  { return hw(&ISwitchController::getContinue) || button(PANEL_BUTTON_CONTINUE); }
+    bool getExamine() override   { return hw(&ISwitchController::getExamine) || button(PANEL_BUTTON_EXAMINE); }
+    bool getDeposit() override   { return hw(&ISwitchController::getDeposit) || button(PANEL_BUTTON_DEPOSIT); }
+    bool getReadIn() override    { return hw(&ISwitchController::getReadIn) || button(PANEL_BUTTON_READIN); }
+
+    bool getStartDownPressed() override { return hw(&ISwitchController::getStartDownPressed) || button(PANEL_BUTTON_START); }
+    bool getStartUpPressed() override   { return hw(&ISwitchController::getStartUpPressed) || button(PANEL_BUTTON_START_UP); }
+    bool getStopPressed() override      { return hw(&ISwitchController::getStopPressed) || button(PANEL_BUTTON_STOP); }
+    bool getContinuePressed() override  { return hw(&ISwitchController::getContinuePressed) || button(PANEL_BUTTON_CONTINUE); }
+    bool getExaminePressed() override   { return hw(&ISwitchController::getExaminePressed) || button(PANEL_BUTTON_EXAMINE); }
+    bool getDepositPressed() override   { return hw(&ISwitchController::getDepositPressed) || button(PANEL_BUTTON_DEPOSIT); }
+    bool getReadInPressed() override    { return hw(&ISwitchController::getReadInPressed) || button(PANEL_BUTTON_READIN); }
+    bool getSingleStepPressed() override  { return hw(&ISwitchController::getSingleStepPressed); }
+    bool getSingleInstrPressed() override { return hw(&ISwitchController::getSingleInstrPressed); }
+
+    void printStatus() override {
+        if (hardware) hardware->printStatus();
+        Serial.println("\n=== Web Panel Switches ===");
+        Serial.printf("Address: %04o  Test Word: %06o  Toggles: %04o\n",
+                      webPanel.getAddress(), webPanel.getTestWord(), webPanel.getToggles());
+        Serial.println("==========================\n");
+    }
+};
+
+#endif // WEBPANEL_H
@@ -1,7 +1,7 @@
 /*
 MULTICORE-SAFE WEBSERVER.H
 Alle CPU-Zugriffe mit Mutex geschützt
-Display-Buffer ist thread-safe
+Display-Punkte laufen lock-free über einen SPSC-Ring (Core 1 -> Core 0)
 */
 
 //benötigt für webserver
@@ -9,6 +9,17 @@ Display-Buffer ist thread-safe
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 #include <ArduinoJson.h>
+#include "ringbuffer.h"
+#include "displaycoalescer.h"
+#include "displayclients.h"
+#include "wsbuffers.h"
+#include "displayraster.h"
+#include "webpanel.h"
+#include "memoryhttp.h"
+#include "webassets.h"
+#include "wscommands.h"
+#include "metrics.h"
+#include "wifilink.h"
 
 // Forward declarations
 class PDP1;
@@ -17,6 +28,9 @@ class RIMLoader;
 // Externe Referenzen (werden in pdp1_simulator_multicore.ino definiert)
 extern PDP1 cpu;
 extern SemaphoreHandle_t cpuMutex;  // MULTICORE: Mutex für CPU-Zugriffe
+extern TaskHandle_t cpuTaskHandle;
+extern volatile uint32_t g_instructionsExecuted;
+extern volatile uint32_t g_firstInstructionMicros;
 
 // WiFi Credentials
 const char* ssid = "YourDataHere";
@@ -27,117 +41,69 @@ AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
 // ============================================================================
-// MULTICORE: Display Buffer mit Mutex-Schutz
+// MULTICORE: Display-Punkte lock-free von Core 1 (dpy) an Core 0 (Senden)
 // ============================================================================
-static std::vector<uint32_t> displayBuffer;
-static SemaphoreHandle_t displayMutex = NULL;
+#define DISPLAY_RING_SIZE  8192   // Punkte, ~250 ms Spacewar bei 33 ms Sende-Takt
+static SpscRing<uint32_t, DISPLAY_RING_SIZE> displayRing;
 
-// Globaler Buffer für Punch 
-static std::vector<uint8_t> punchBuffer;
-static SemaphoreHandle_t punchMutex = NULL;
+// Binäres Display-Protokoll: 4 Byte Header (Byte 0 = Frame-Typ), danach
+// die gepackten Punkte als little-endian uint32 (ESP32 ist little-endian,
+// der Browser liest sie direkt als Uint32Array). Text-JSON bleibt als
+// Fallback für Clients, die connect_dpy ohne "binary":true schicken.
+#define WS_FRAME_DISPLAY          0x01
+#define DISPLAY_FRAME_MAX_POINTS  2048   // 8 KB pro Frame
+static uint32_t displayFrame[1 + DISPLAY_FRAME_MAX_POINTS];
+static uint32_t displayPending[2];      // angefangenes Escape-Tripel am Frame-Ende
+static size_t displayPendingCount = 0;
+
+// Optional (connect_dpy "coalesce":true, nur binär): gleiche Punkte pro
+// Frame zusammenfassen. Frame-Typ 0x02, Header Bytes 1-3 = emulierte
+// Dauer des Frames in µs, Punkte siehe displaycoalescer.h
+#define WS_FRAME_DISPLAY_MERGED   0x02
+static DisplayCoalescer displayCoalescer;
+static uint32_t displayMergedFrame[DISPLAY_FRAME_MAX_POINTS];   // eigener Puffer: läuft neben displayFrame
+static uint32_t coalesceSpan = 0;  // Zeit des angefangenen Merge-Frames
+static uint32_t coalesceIn = 0;    // Punkte vor dem Zusammenfassen
+static uint32_t coalesceOut = 0;   // gesendete Punkte
+
+// Zuschauer mit eigener Backpressure-Policy (displayclients.h).
+// Tabelle wird vom AsyncTCP-Task (connect_dpy) und von loop() benutzt.
+static DisplayClientTable displayClients;
+static SemaphoreHandle_t displayClientsMutex = NULL;
+
+// Statistik für 'i' (Punkte/s, Bytes/s seit der letzten Abfrage)
+static uint32_t displayPointsSent = 0;
+static uint32_t displayBytesSent = 0;
+static uint32_t displayEncodeMicros = 0;   // Frames/JSON bauen (Benchmark 'a')
+static uint32_t displayQueueMicros = 0;    // an Client-Queues hängen
 
 // NEU: Web-Tape Mount System
+// webTapeData gehört dem Reader; wer das Tape liest (RIMLoader, /tape/reader)
+// holt sich unter webTapeMutex eine eigene Referenz (TapeData, cpu.h).
+// Mount/Unmount lassen nur die Referenz des Readers los.
 static bool webTapeMounted = false;
-static std::vector<uint8_t> webTapeData;
+static std::shared_ptr<std::vector<uint8_t>> webTapeData;
 static size_t webTapePosition = 0;
 static SemaphoreHandle_t webTapeMutex = NULL;
 
-// Status
+// Chunked Binary-Upload: mount_begin (JSON) -> Binary-Frames -> reader_mounted
+// Die Frames werden direkt in webTapeData geschrieben, ohne Zwischenkopie.
+#define WEB_TAPE_MAX_SIZE    (64 * 1024)   // reicht für 16K Worte + Leader
+#define WEB_TAPE_CHUNK_SIZE  4096          // Bytes pro Binary-Frame
+#define WEB_TAPE_WINDOW      4             // Frames ohne Ack unterwegs (Flow Control)
+static uint32_t webTapeUploadClient = 0;   // 0 = kein Upload aktiv
+static size_t webTapeUploadSize = 0;
+static size_t webTapeUploadReceived = 0;
+
+// Status: mindestens ein Client hat connect_dpy geschickt
 bool displayConnected = false;
 
+// Nicht blockierend: verbindet im Hintergrund (wifilink.h), loop() ruft
+// wifiLink.service() auf. Der Simulator läuft auch ganz ohne Netz.
 void setup_wifi(){
-    // WiFi verbinden
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
-    
-    Serial.print("Connecting to WiFi");
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
-    }
-    
-    Serial.println("\nWiFi connected");
-    Serial.print("IP address: ");
-    Serial.println(WiFi.localIP());
+    wifiLink.begin(ssid, password);
 }
 
-// Base64 Dekodierung
-uint8_t* base64_decode(const char* input, size_t* output_length) {
-    static const char base64_chars[] = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    
-    size_t input_length = strlen(input);
-    if (input_length % 4 != 0) {
-        Serial.println("Base64: invalid Length!");
-        return nullptr;
-    }
-    
-    *output_length = input_length / 4 * 3;
-    if (input[input_length - 1] == '=') (*output_length)--;
-    if (input[input_length - 2] == '=') (*output_length)--;
-    
-    uint8_t* output = new uint8_t[*output_length];
-    
-    for (size_t i = 0, j = 0; i < input_length;) {
-        uint32_t a, b, c, d;
-        
-        if (input[i] == '=') {
-            a = 0; i++;
-        } else {
-            const char* pos = strchr(base64_chars, input[i++]);
-            if (pos == nullptr) {
-                Serial.printf("Base64: invalid Char on Position %d\n", i-1);
-                delete[] output;
-                return nullptr;
-            }
-            a = pos - base64_chars;
-        }
-        
-        if (input[i] == '=') {
-            b = 0; i++;
-        } else {
-            const char* pos = strchr(base64_chars, input[i++]);
-            if (pos == nullptr) {
-                delete[] output;
-                return nullptr;
-            }
-            b = pos - base64_chars;
-        }
-        
-        if (input[i] == '=') {
-            c = 0; i++;
-        } else {
-            const char* pos = strchr(base64_chars, input[i++]);
-            if (pos == nullptr) {
-                delete[] output;
-                return nullptr;
-            }
-            c = pos - base64_chars;
-        }
-        
-        if (input[i] == '=') {
-            d = 0; i++;
-        } else {
-            const char* pos = strchr(base64_chars, input[i++]);
-            if (pos == nullptr) {
-                delete[] output;
-                return nullptr;
-            }
-            d = pos - base64_chars;
-        }
-        
-        uint32_t triple = (a << 18) + (b << 12) + (c << 6) + d;
-        
-        if (j < *output_length) output[j++] = (triple >> 16) & 0xFF;
-        if (j < *output_length) output[j++] = (triple >> 8) & 0xFF;
-        if (j < *output_length) output[j++] = triple & 0xFF;
-    }
-    
-    return output;
-}
-
-
-
 // ========================================
 // Status Messages
 // ========================================
@@ -149,32 +115,63 @@ void sendMessage(const char* text) {
     doc["type"] = "message";
     doc["text"] = text;
     
-    String json;
-    serializeJson(doc, json);
-    ws.textAll(json);
+    // Einmal in einen Pool-Puffer serialisieren, alle Clients teilen ihn
+    size_t len = measureJson(doc);
+    AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(len + 1);
+    serializeJson(doc, (char*)buffer->data(), len + 1);
+    buffer->resize(len);
+    ws.textAll(buffer);
 }
 
-std::vector<uint8_t> getWebTapeData() {
-    std::vector<uint8_t> copy;
+// Liefert eine eigene Referenz auf das gemountete Tape (KEINE Kopie),
+// leer wenn keins gemountet ist. Bleibt gültig, auch wenn das Tape
+// inzwischen ausgeworfen oder ersetzt wurde.
+TapeData getWebTape() {
+    TapeData tape;
     if (webTapeMutex && xSemaphoreTake(webTapeMutex, 100) == pdTRUE) {
-        copy = webTapeData;
+        if (webTapeMounted) tape = webTapeData;
         xSemaphoreGive(webTapeMutex);
     }
-    return copy;
+    return tape;
+}
+
+// Altes Tape aus dem Reader nehmen, bevor ein neues gemountet wird.
+// false = CPU nicht erreichbar, das alte Tape steckt noch im Reader
+static bool ejectReaderTape() {
+    if (!cpuMutexTake(100)) return false;
+    RIMLoader::ejectTape();
+    xSemaphoreGive(cpuMutex);
+    return true;
 }
 
 // ========================================
-// Tape Position Updates (für Animation)
+// Device Status (Reader-Position, Punch, Typewriter)
 // ========================================
-void sendReaderPosition(size_t position) {
-    static unsigned long lastSend = 0;
-    if (millis() - lastSend < 50) return;  // Rate-limit: alle 50ms (20 FPS)
+
+// WIRD VON MAIN LOOP (CORE 0) AUFGERUFEN - alle DEVICE_STATUS_INTERVAL ms.
+// Core 1 zählt nur atomare Zähler hoch, gesendet wird nur bei Änderung.
+void sendDeviceStatus() {
+    static uint32_t lastReader = 0;
+    static uint32_t lastPunch = 0;
+    static uint32_t lastTypewriter = 0;
+    
+    uint32_t reader = deviceStatus.readerPosition.load(std::memory_order_relaxed);
+    uint32_t punch = deviceStatus.punchCount.load(std::memory_order_relaxed);
+    uint32_t typewriter = deviceStatus.typewriterCount.load(std::memory_order_relaxed);
     
+    if (reader == lastReader && punch == lastPunch && typewriter == lastTypewriter) return;
     if (!ws.count()) return;  // Keine Clients connected
     
-    String json = "{\"type\":\"reader_position\",\"position\":" + String(position) + "}";
-    ws.textAll(json);
-    lastSend = millis();
+    AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(96);
+    int len = snprintf((char*)buffer->data(), 96,
+                       "{\"type\":\"status\",\"reader\":%lu,\"punched\":%lu,\"typed\":%lu}",
+                       (unsigned long)reader, (unsigned long)punch, (unsigned long)typewriter);
+    buffer->resize(len < 96 ? len : 95);
+    ws.textAll(buffer);
+    
+    lastReader = reader;
+    lastPunch = punch;
+    lastTypewriter = typewriter;
 }
 
 // ========================================
@@ -182,48 +179,120 @@ void sendReaderPosition(size_t position) {
 // ========================================
 
 // MULTICORE-SAFE: Alle CPU-Zugriffe mit Mutex
-void handleMountReader(JsonDocument& doc) {
-    const char* base64Data = doc["data"];
-    size_t dataLen;
-    
-    // Base64 dekodieren
-    uint8_t* rimData = base64_decode(base64Data, &dataLen);
+// Schritt 1: MOUNT_BEGIN mit der Größe - Buffer einmalig anlegen
+void handleMountReader(AsyncWebSocketClient *client, size_t size) {
+    if (size == 0 || size > WEB_TAPE_MAX_SIZE || size > ESP.getMaxAllocHeap()) {
+        Serial.printf("[WEBSERVER] Tape rejected: %u bytes\n", (unsigned)size);
+        client->text("{\"type\":\"mount_error\",\"text\":\"Invalid tape size\"}");
+        return;
+    }
     
-    if (rimData == nullptr) {
-        sendMessage("ERROR: Invalid RIM data!");
+    if (!ejectReaderTape()) {
+        client->text("{\"type\":\"mount_error\",\"text\":\"CPU busy, tape not ejected\"}");
         return;
     }
     
-    // Als virtuelles Tape mounten (NICHT laden!)
+    // Vor dem Mutex anlegen - die Allokation kann dauern
+    std::shared_ptr<std::vector<uint8_t>> tape = std::make_shared<std::vector<uint8_t>>(size);
+    
     if (webTapeMutex && xSemaphoreTake(webTapeMutex, 100) == pdTRUE) {
-        webTapeData.clear();
-        webTapeData.assign(rimData, rimData + dataLen);
+        webTapeMounted = false;
+        webTapeData = tape;  // alter Buffer wird frei, sobald niemand ihn mehr liest
         webTapePosition = 0;
+        webTapeUploadClient = client->id();
+        webTapeUploadSize = size;
+        webTapeUploadReceived = 0;
+        xSemaphoreGive(webTapeMutex);
+    } else {
+        client->text("{\"type\":\"mount_error\",\"text\":\"Tape busy\"}");
+        return;
+    }
+    
+    Serial.printf("[WEBSERVER] Tape upload started: %u bytes\n", (unsigned)size);
+    
+    char json[80];
+    snprintf(json, sizeof(json), "{\"type\":\"mount_ready\",\"chunk\":%u,\"window\":%u}",
+             WEB_TAPE_CHUNK_SIZE, WEB_TAPE_WINDOW);
+    client->text(json);
+}
+
+// Schritt 2: TAPE_CHUNK-Frames direkt in den Tape-Buffer schreiben.
+// AsyncWebSocket liefert große Frames in Stücken: offset = Position im
+// Chunk (ohne Opcode-Byte), total = Länge des Chunks.
+void handleTapeChunk(AsyncWebSocketClient *client, size_t chunkOffset, size_t chunkLen,
+                     const uint8_t *data, size_t len) {
+    if (webTapeUploadClient == 0 || client->id() != webTapeUploadClient) {
+        return;
+    }
+    
+    size_t offset = webTapeUploadReceived + chunkOffset;
+    if (offset + len > webTapeUploadSize) {
+        Serial.println("[WEBSERVER] Tape upload overflow - aborted");
+        webTapeUploadClient = 0;
+        client->text("{\"type\":\"mount_error\",\"text\":\"Tape upload overflow\"}");
+        return;
+    }
+    
+    if (webTapeMutex == NULL || xSemaphoreTake(webTapeMutex, 100) != pdTRUE) {
+        Serial.println("[WEBSERVER] Tape busy - upload aborted");
+        webTapeUploadClient = 0;
+        client->text("{\"type\":\"mount_error\",\"text\":\"Tape busy\"}");
+        return;
+    }
+    // Unmount während des Uploads? Dann gibt es keinen Buffer mehr
+    if (!webTapeData || offset + len > webTapeData->size()) {
+        xSemaphoreGive(webTapeMutex);
+        webTapeUploadClient = 0;
+        return;
+    }
+    memcpy(webTapeData->data() + offset, data, len);
+    xSemaphoreGive(webTapeMutex);
+    
+    // Frame noch nicht komplett?
+    if (chunkOffset + len < chunkLen) return;
+    
+    webTapeUploadReceived += chunkLen;
+    
+    char json[96];
+    if (webTapeUploadReceived < webTapeUploadSize) {
+        // Ack = Flow Control + Fortschritt für den Browser
+        snprintf(json, sizeof(json), "{\"type\":\"mount_progress\",\"received\":%u,\"total\":%u}",
+                 (unsigned)webTapeUploadReceived, (unsigned)webTapeUploadSize);
+        client->text(json);
+        return;
+    }
+    
+    // Schritt 3: Upload komplett - als virtuelles Tape mounten (NICHT laden!)
+    if (webTapeMutex && xSemaphoreTake(webTapeMutex, 100) == pdTRUE) {
         webTapeMounted = true;
+        webTapeUploadClient = 0;
         xSemaphoreGive(webTapeMutex);
-        
-        Serial.printf("[WEBSERVER] Tape mounted: %d bytes\n", dataLen);
-        sendMessage("Paper Tape mounted! Use READ IN switch to load.");
-        
-        // Tape im Browser anzeigen mit pos daten
-        String json = "{\"type\":\"reader_mounted\",\"position\":0,\"data\":\"";
-        json += base64Data;
-        json += "\"}";
-        ws.textAll(json);
     }
     
-    delete[] rimData;
+    Serial.printf("[WEBSERVER] Tape mounted: %u bytes\n", (unsigned)webTapeUploadSize);
+    sendMessage("Paper Tape mounted! Use READ IN switch to load.");
+    
+    // Nur die Größe verteilen - andere Clients holen das Tape über /tape/reader
+    snprintf(json, sizeof(json), "{\"type\":\"reader_mounted\",\"position\":0,\"size\":%u}",
+             (unsigned)webTapeUploadSize);
+    ws.textAll(json);
 }
 
 // ============================================================================
 // handleUnmountReader - NEU
 // ============================================================================
 
-void handleUnmountReader() {
+void handleUnmountReader(AsyncWebSocketClient *client) {
+    if (!ejectReaderTape()) {
+        client->text("{\"type\":\"mount_error\",\"text\":\"CPU busy, tape not ejected\"}");
+        return;
+    }
+    
     if (webTapeMutex && xSemaphoreTake(webTapeMutex, 100) == pdTRUE) {
         webTapeMounted = false;
-        webTapeData.clear();
+        webTapeData.reset();
         webTapePosition = 0;
+        webTapeUploadClient = 0;
         xSemaphoreGive(webTapeMutex);
         
         ws.textAll("{\"type\":\"reader_unmounted\"}");
@@ -246,6 +315,330 @@ bool isWebTapeMounted() {
     return mounted;
 }
 
+// Display-Clients an-/abmelden (AsyncTCP-Task)
+static bool addPanelClient(uint32_t id) {
+    if (!webPanel.lockClients(100)) return false;
+    bool ok = webPanel.add(id);
+    webPanel.unlockClients();
+    return ok;
+}
+
+static void removePanelClient(uint32_t id) {
+    if (!webPanel.lockClients(100)) return;
+    if (webPanel.remove(id)) {
+        Serial.printf("[WEBSERVER] Panel #%u disconnected\n", id);
+    }
+    webPanel.unlockClients();
+}
+
+static bool addDisplayClient(uint32_t id, bool binary, bool coalesce, bool raster, uint8_t policy) {
+    bool ok = false;
+    if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 100) == pdTRUE) {
+        if (!raster || displayRaster.begin()) {
+            ok = displayClients.add(id, binary, coalesce, raster, policy) != nullptr;
+        }
+        displayConnected = displayClients.count() > 0;
+        xSemaphoreGive(displayClientsMutex);
+    }
+    return ok;
+}
+
+static void removeDisplayClient(uint32_t id) {
+    if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 100) == pdTRUE) {
+        displayClients.remove(id);
+        displayConnected = displayClients.count() > 0;
+        xSemaphoreGive(displayClientsMutex);
+    }
+}
+
+// ============================================================================
+// Kommandos - gemeinsam für JSON und das binäre Protokoll (wscommands.h)
+// ============================================================================
+
+static void cmdConnectDisplay(AsyncWebSocketClient *client, bool binary, bool coalesce,
+                              bool raster, uint8_t policy) {
+    raster = binary && raster;
+    if (addDisplayClient(client->id(), binary, coalesce, raster, policy)) {
+        client->text("{\"type\":\"dpy_connected\"}");
+        Serial.printf("[WEBSERVER] Display #%u connected (%s%s, %s)\n", client->id(),
+                      raster ? "raster" : (binary ? "binary" : "text"),
+                      (binary && coalesce && !raster) ? ", coalesced" : "",
+                      displayPolicyName(policy));
+    } else {
+        client->text(raster ?
+            "{\"type\":\"message\",\"text\":\"ERROR: Raster display not available!\"}" :
+            "{\"type\":\"message\",\"text\":\"ERROR: Too many display clients!\"}");
+    }
+}
+
+static void cmdDisconnectDisplay(AsyncWebSocketClient *client) {
+    removeDisplayClient(client->id());
+    client->text("{\"type\":\"dpy_disconnected\"}");
+    Serial.printf("[WEBSERVER] Display #%u disconnected\n", client->id());
+}
+
+static void cmdConnectPanel(AsyncWebSocketClient *client) {
+    if (addPanelClient(client->id())) {
+        client->text("{\"type\":\"panel_connected\"}");
+        Serial.printf("[WEBSERVER] Panel #%u connected\n", client->id());
+    } else {
+        client->text("{\"type\":\"message\",\"text\":\"ERROR: Too many panel clients!\"}");
+    }
+}
+
+static void cmdUnmount(AsyncWebSocketClient *client) {
+    Serial.println("[WEBSERVER] Unmount paper tape reader");
+    handleUnmountReader(client);
+}
+
+static void cmdPunchNew(AsyncWebSocketClient *client, const char* name) {
+    switch (punchDevice.requestNewTape(name)) {
+        case PUNCH_REQUEST_OK:
+            sendMessage("New punch tape started");
+            break;
+        case PUNCH_REQUEST_BUSY:
+            client->text("{\"type\":\"punch_error\",\"text\":\"Punch busy, try again\"}");
+            break;
+        case PUNCH_REQUEST_INVALID:
+            client->text("{\"type\":\"punch_error\",\"text\":\"Invalid punch tape name\"}");
+            break;
+        case PUNCH_REQUEST_EXISTS:
+            client->text("{\"type\":\"punch_error\",\"text\":\"Punch tape exists, choose another name\"}");
+            break;
+    }
+}
+
+static void cmdPunchFinish() {
+    punchDevice.requestFinishTape();
+    sendMessage("Punch tape finished");
+}
+
+static void cmdKey(uint8_t keyCode) {
+    // In die Tastatur-FIFO, die CPU liest mit tyi (PF1)
+    if (!typewriterDevice.pushKey(keyCode)) {
+        Serial.printf("[WEBSERVER] Key FIFO full, dropped 0x%02X\n", keyCode);
+    }
+}
+
+static void cmdSetSwitches(uint8_t row, uint32_t value) {
+    switch (row) {
+        case 0: webPanel.setAddress(value); break;
+        case 1: webPanel.setTestWord(value); break;
+        case 2: webPanel.setToggles(value); break;
+    }
+}
+
+// Debugger (nur binär), jeweils kurz unter cpuMutex
+static bool cmdDebug(AsyncWebSocketClient *client, uint8_t op, const uint8_t* payload, size_t len) {
+    uint8_t reply[5 + WS_EXAMINE_MAX * 4];
+    size_t replyLen = 0;
+    
+    if (!cpuMutexTake(100)) {
+        sendMessage("ERROR: CPU busy!");
+        return false;
+    }
+    switch (op) {
+        case WS_CMD_CPU_RUN:
+            cpu.run();
+            break;
+        case WS_CMD_CPU_STOP:
+            if (cpu.isRunning()) cpu.stop();
+            break;
+        case WS_CMD_CPU_STEP:
+            cpu.step();
+            cpu.updateLEDs();
+            break;
+        case WS_CMD_CPU_RESET:
+            cpu.reset();
+            break;
+        case WS_CMD_EXAMINE:
+            if (len >= 3) {
+                uint16_t addr = wsRead16(payload) & (EXTENDED_MEM_SIZE - 1);
+                uint8_t count = payload[2];
+                if (count > WS_EXAMINE_MAX) count = WS_EXAMINE_MAX;
+                if (count > EXTENDED_MEM_SIZE - addr) count = EXTENDED_MEM_SIZE - addr;
+                const uint32_t* memory = cpu.getMemory();
+                reply[0] = WS_FRAME_DEBUG;
+                reply[1] = op;
+                wsWrite16(&reply[2], addr);
+                reply[4] = count;
+                for (uint8_t i = 0; i < count; i++) {
+                    wsWrite32(&reply[5 + i * 4], memory[addr + i] & WORD_MASK);
+                }
+                replyLen = 5 + count * 4;
+            }
+            break;
+        case WS_CMD_DEPOSIT:
+            if (len >= 6) {
+                uint16_t addr = wsRead16(payload) & (EXTENDED_MEM_SIZE - 1);
+                cpu.getMemory()[addr] = wsRead32(payload + 2) & WORD_MASK;
+            }
+            break;
+        case WS_CMD_STATE:
+            reply[0] = WS_FRAME_DEBUG;
+            reply[1] = op;
+            wsWrite16(&reply[2], cpu.getPC());
+            wsWrite32(&reply[4], cpu.getAC());
+            wsWrite32(&reply[8], cpu.getIO());
+            reply[12] = (cpu.isRunning() ? 0x01 : 0) | (cpu.getOV() ? 0x02 : 0);
+            replyLen = 13;
+            break;
+        default:
+            xSemaphoreGive(cpuMutex);
+            return false;
+    }
+    xSemaphoreGive(cpuMutex);
+    
+    if (replyLen > 0) {
+        AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(replyLen);
+        memcpy(buffer->data(), reply, replyLen);
+        client->binary(buffer);
+    }
+    return true;
+}
+
+// Für 'i': Kosten pro Protokoll
+static WsCommandStats wsJsonStats = {};
+static WsCommandStats wsBinaryStats = {};
+// Client, dessen laufender Binär-Frame ein TAPE_CHUNK ist (0 = keiner).
+// Pro Verbindung: Frames anderer Clients dürfen dazwischen ankommen.
+static uint32_t webTapeFrameClient = 0;
+
+// Kompatibilität: {"type":"...", ...}
+static void handleJsonCommand(AsyncWebSocketClient *client, const uint8_t *data, size_t len) {
+    unsigned long start = micros();
+    
+    // Länge mitgeben statt data[len] = 0 (hinter dem Frame)
+    StaticJsonDocument<WS_JSON_DOC_SIZE> doc;
+    DeserializationError error = deserializeJson(doc, (const char*)data, len);
+    const char* msgType = error ? nullptr : (const char*)doc["type"];
+    if (msgType == nullptr) {
+        Serial.println("[WEBSERVER] JSON parse error");
+        wsJsonStats.errors++;
+        return;
+    }
+    
+    if (strcmp(msgType, "key") == 0) {
+        cmdKey(doc["value"]);
+    } else if (strcmp(msgType, "connect_dpy") == 0) {
+        cmdConnectDisplay(client, doc["binary"] | false, doc["coalesce"] | false,
+                          doc["raster"] | false, displayPolicyFromName(doc["policy"] | "drop"));
+    } else if (strcmp(msgType, "disconnect_dpy") == 0) {
+        cmdDisconnectDisplay(client);
+    } else if (strcmp(msgType, "mount_begin") == 0) {
+        handleMountReader(client, doc["size"] | 0);
+    } else if (strcmp(msgType, "unmount_reader") == 0) {
+        cmdUnmount(client);
+    } else if (strcmp(msgType, "punch_new") == 0) {
+        cmdPunchNew(client, doc["name"] | "");
+    } else if (strcmp(msgType, "punch_finish") == 0) {
+        cmdPunchFinish();
+    } else if (strcmp(msgType, "connect_panel") == 0) {
+        cmdConnectPanel(client);
+    } else if (strcmp(msgType, "disconnect_panel") == 0) {
+        removePanelClient(client->id());
+    } else if (strcmp(msgType, "panel_switch") == 0) {
+        // Nur die mitgeschickten Schalterreihen ändern
+        if (doc["address"].is<uint32_t>()) cmdSetSwitches(0, doc["address"]);
+        if (doc["testword"].is<uint32_t>()) cmdSetSwitches(1, doc["testword"]);
+        if (doc["toggles"].is<uint32_t>()) cmdSetSwitches(2, doc["toggles"]);
+    } else if (strcmp(msgType, "panel_flip") == 0) {
+        webPanel.flipSwitch(doc["row"], doc["bit"] | 0);
+    } else if (strcmp(msgType, "panel_button") == 0) {
+        uint8_t button = panelButtonFromName(doc["button"]);
+        if (button) webPanel.pressButtons(button);
+    } else {
+        wsJsonStats.errors++;
+    }
+    
+    wsJsonStats.record(start, wsStackDepth());
+}
+
+// Binär: Opcode + Nutzdaten. Nur TAPE_CHUNK darf fragmentiert ankommen.
+static void handleBinaryCommand(AsyncWebSocketClient *client, AwsFrameInfo *info,
+                                const uint8_t *data, size_t len) {
+    // Fortsetzung eines Tape-Frames (kein Opcode in diesem Stück)
+    if (info->index > 0) {
+        if (client->id() == webTapeFrameClient) {
+            handleTapeChunk(client, info->index - 1, info->len - 1, data, len);
+        }
+        return;
+    }
+    // Neuer Frame dieses Clients: sein voriger TAPE_CHUNK ist vollständig
+    if (client->id() == webTapeFrameClient) webTapeFrameClient = 0;
+    if (len == 0) return;
+    
+    unsigned long start = micros();
+    uint8_t op = data[0];
+    const uint8_t* payload = data + 1;
+    size_t n = len - 1;
+    static const char* rowNames[] = { "address", "testword", "toggles" };
+    bool ok = true;
+    
+    switch (op) {
+        case WS_CMD_KEY:
+            if ((ok = n >= 1)) cmdKey(payload[0]);
+            break;
+        case WS_CMD_PANEL_SWITCH:
+            if ((ok = n >= 5)) cmdSetSwitches(payload[0], wsRead32(payload + 1));
+            break;
+        case WS_CMD_PANEL_FLIP:
+            if ((ok = n >= 2 && payload[0] < 3)) webPanel.flipSwitch(rowNames[payload[0]], payload[1]);
+            break;
+        case WS_CMD_PANEL_BUTTON:
+            if ((ok = n >= 1)) webPanel.pressButtons(payload[0]);
+            break;
+        case WS_CMD_CONNECT_DPY:
+            if ((ok = n >= 2)) {
+                uint8_t policy = payload[1] <= DISPLAY_POLICY_RATE ? payload[1] : DISPLAY_POLICY_DROP;
+                cmdConnectDisplay(client, payload[0] & WS_DPY_FLAG_BINARY, payload[0] & WS_DPY_FLAG_COALESCE,
+                                  payload[0] & WS_DPY_FLAG_RASTER, policy);
+            }
+            break;
+        case WS_CMD_DISCONNECT_DPY:
+            cmdDisconnectDisplay(client);
+            break;
+        case WS_CMD_CONNECT_PANEL:
+            cmdConnectPanel(client);
+            break;
+        case WS_CMD_DISCONNECT_PANEL:
+            removePanelClient(client->id());
+            break;
+        case WS_CMD_MOUNT_BEGIN:
+            if ((ok = n >= 4)) handleMountReader(client, wsRead32(payload));
+            break;
+        case WS_CMD_TAPE_CHUNK:
+            if (client->id() == webTapeUploadClient) webTapeFrameClient = client->id();
+            handleTapeChunk(client, 0, info->len - 1, payload, n);
+            return;     // Datenpfad, nicht in der Kommando-Statistik
+        case WS_CMD_UNMOUNT:
+            cmdUnmount(client);
+            break;
+        case WS_CMD_PUNCH_NEW:
+            {
+                char name[PUNCH_NAME_MAX + 1];
+                size_t l = n < PUNCH_NAME_MAX ? n : PUNCH_NAME_MAX;
+                memcpy(name, payload, l);
+                name[l] = 0;
+                cmdPunchNew(client, name);
+            }
+            break;
+        case WS_CMD_PUNCH_FINISH:
+            cmdPunchFinish();
+            break;
+        default:
+            if (op >= WS_CMD_CPU_RUN && op <= WS_CMD_STATE) {
+                ok = cmdDebug(client, op, payload, n);
+            } else {
+                ok = false;
+            }
+            break;
+    }
+    
+    if (!ok) wsBinaryStats.errors++;
+    wsBinaryStats.record(start, wsStackDepth());
+}
+
 void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, 
                AwsEventType type, void *arg, uint8_t *data, size_t len) {
     
@@ -257,54 +650,24 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
             
         case WS_EVT_DISCONNECT:
             Serial.printf("[WEBSERVER] WebSocket client #%u disconnected\n", client->id());
-            if (displayConnected) {
-                displayConnected = false;
+            if (client->id() == webTapeUploadClient) {
+                webTapeUploadClient = 0;  // abgebrochener Upload
             }
+            if (client->id() == webTapeFrameClient) webTapeFrameClient = 0;
+            removeDisplayClient(client->id());
+            removePanelClient(client->id());
             break;
             
         case WS_EVT_DATA:
             {
                 AwsFrameInfo *info = (AwsFrameInfo*)arg;
+                wsMarkStack();
                 
-                if (info->final && info->index == 0 && info->len == len && 
-                    info->opcode == WS_TEXT) {
-                    
-                    data[len] = 0;  // Null-terminieren
-                    
-                    // JSON parsen
-                    StaticJsonDocument<4096> doc;
-                    DeserializationError error = deserializeJson(doc, (char*)data);
-                    
-                    if (error) {
-                        Serial.println("[WEBSERVER] JSON parse error");
-                        return;
-                    }
-                    
-                    const char* msgType = doc["type"];
-                    
-                    if (strcmp(msgType, "connect_dpy") == 0) {
-                        displayConnected = true;
-                        ws.textAll("{\"type\":\"dpy_connected\"}");
-                        Serial.println("[WEBSERVER] Display connected");
-                        
-                    } else if (strcmp(msgType, "disconnect_dpy") == 0) {
-                        displayConnected = false;
-                        ws.textAll("{\"type\":\"dpy_disconnected\"}");
-                        Serial.println("[WEBSERVER] Display disconnected");
-                        
-                    } else if (strcmp(msgType, "mount_reader") == 0) {
-                        handleMountReader(doc);
-                        
-                    } else if (strcmp(msgType, "unmount_reader") == 0) {
-                        Serial.println("[WEBSERVER] Unmount paper tape reader");
-                        handleUnmountReader();
-                        
-                    } else if (strcmp(msgType, "key") == 0) {
-                        uint8_t keyCode = doc["value"];
-                        Serial.printf("[WEBSERVER] Key pressed: 0x%02X (%c)\n", keyCode, 
-                                     (keyCode >= 32 && keyCode < 127) ? keyCode : '?');
-                        // TODO: An PDP-1 Keyboard Interface weiterleiten
-                    }
+                if (info->opcode == WS_BINARY) {
+                    handleBinaryCommand(client, info, data, len);
+                } else if (info->final && info->index == 0 && info->len == len && 
+                           info->opcode == WS_TEXT) {
+                    handleJsonCommand(client, data, len);
                 }
             }
             break;
@@ -315,78 +678,613 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
     }
 }
 
+// Für 'i'
+void printWsCommandStats() {
+    wsJsonStats.print("json");
+    wsBinaryStats.print("binary");
+}
+
 // ========================================
 // Display Output Funktionen (MULTICORE-SAFE)
 // ========================================
 
 // WIRD VON CPU-TASK (CORE 1) AUFGERUFEN
-void handleDisplayOutput(int16_t x, int16_t y, uint8_t intensity) {
+// Punkt-Format (32 Bit): x Bits 0-9, y Bits 10-19, Intensität Bits 20-22,
+// dt Bits 23-31 = emulierte µs seit dem vorigen Punkt. Längere Pausen:
+// Escape-Punkt mit dt = 511, das nächste Wort ist das volle Delta.
+#define DISPLAY_DT_ESCAPE  511
+
+// WIRD VON CPU-TASK (CORE 1) AUFGERUFEN
+// time: emulierte Zeit in µs (PDP1::simTime)
+void handleDisplayOutput(int16_t x, int16_t y, uint8_t intensity, uint32_t time) {
     // x, y: -511 bis +511
     // intensity: 0-7
+    static uint32_t lastTime = 0;
  
     // Zu unsigned konvertieren (0-1023)
     uint16_t x_u = (x + 512) & 0x3FF;
     uint16_t y_u = (y + 512) & 0x3FF;
     
+    uint32_t dt = time - lastTime;
+    lastTime = time;
+    
     // Packen
     uint32_t point = (intensity << 20) | (y_u << 10) | x_u;
     
-    // MULTICORE: Buffer-Zugriff mit Mutex schützen
-    if (displayMutex != NULL) {
-        if (xSemaphoreTake(displayMutex, 1) == pdTRUE) {
-            displayBuffer.push_back(point);
-            xSemaphoreGive(displayMutex);
+    // MULTICORE: lock-free, kein Warten. Ring voll -> Punkt verworfen und
+    // im Overflow-Zähler von displayRing mitgezählt.
+    if (dt < DISPLAY_DT_ESCAPE) {
+        displayRing.push(point | (dt << 23));
+    } else {
+        // Escape + Delta + Punkt gehören zusammen: alles oder nichts
+        uint32_t words[3] = { (uint32_t)DISPLAY_DT_ESCAPE << 23, dt, point };
+        displayRing.pushAll(words, 3);
+    }
+}
+
+// ========================================
+// Display-Frames an die Clients verteilen
+// ========================================
+
+// Text-Fallback: gleiches Punkt-Format als JSON
+static AsyncWebSocketSharedBuffer displayPointsJson(const uint32_t* words, size_t n) {
+    WsJsonWriter json(32 + n * 11);
+    json.append("{\"type\":\"points\",\"points\":[");
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) json.appendChar(',');
+        json.appendUint(words[i]);
+    }
+    json.append("]}");
+    return json.finish();
+}
+
+// Binär-Frame: Header + Punkte in einen Pool-Puffer
+static AsyncWebSocketSharedBuffer displayFrameBuffer(uint32_t header, const uint32_t* words, size_t n) {
+    AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire((n + 1) * sizeof(uint32_t));
+    uint8_t* out = buffer->data();
+    memcpy(out, &header, sizeof(uint32_t));
+    memcpy(out + sizeof(uint32_t), words, n * sizeof(uint32_t));
+    return buffer;
+}
+
+// Einen Frame (points[0..n-1]) an die Display-Clients der passenden Art
+// verteilen (merged: nur Clients mit coalesce, sonst nur die anderen).
+// duration: emulierte µs des Frames. Jeder Client bekommt ihn je nach
+// Queue-Tiefe und Policy ganz, ausgedünnt oder gar nicht. Ausgelassene
+// Zeit wird im carry des Clients auf den nächsten Frame übertragen.
+// Clients, die den Frame unverändert bekommen, teilen sich einen Puffer
+// (einmal kodiert, referenzgezählt). Aufruf mit displayClientsMutex.
+static void sendDisplayFrame(const uint32_t* points, size_t n, bool merged, uint32_t duration) {
+    AsyncWebSocketSharedBuffer sharedBinary;
+    AsyncWebSocketSharedBuffer sharedText;
+    
+    for (size_t i = 0; i < displayClients.count(); i++) {
+        DisplayClient& c = displayClients[i];
+        if (c.raster || c.coalesce != merged) continue;
+        AsyncWebSocketClient* client = ws.client(c.id);
+        if (client == nullptr) continue;
+        
+        if (!DisplayClientTable::shouldSend(c, client->queueLen())) {
+            c.framesDropped++;
+            c.pointsSkipped += n;
+            c.carry += duration;
+            continue;
+        }
+        
+        unsigned long encodeStart = micros();
+        uint8_t level = (c.policy == DISPLAY_POLICY_DECIMATE) ? c.level : 0;
+        AsyncWebSocketSharedBuffer buffer;
+        size_t count = n;
+        
+        if (level > 0 || c.carry > 0) {
+            // Eigener Frame für diesen Client: direkt in den Pool-Puffer ausdünnen
+            buffer = wsBuffers.acquire((DISPLAY_FRAME_MAX_POINTS + 4) * sizeof(uint32_t));
+            uint32_t* words = (uint32_t*)buffer->data();
+            uint32_t span = duration + c.carry;     // nur merged: Zeit steht im Header
+            count = decimateDisplayFrame(points, n, merged, level, c,
+                                         &words[1], DISPLAY_FRAME_MAX_POINTS + 3);
+            c.pointsSkipped += n - (count < n ? count : n);
+            if (count == 0) continue;
+            if (merged) {
+                if (span > 0xFFFFFF) span = 0xFFFFFF;
+                c.carry = 0;
+                words[0] = WS_FRAME_DISPLAY_MERGED | (span << 8);
+            } else {
+                words[0] = WS_FRAME_DISPLAY;
+            }
+            if (c.binary) {
+                buffer->resize((count + 1) * sizeof(uint32_t));
+            } else {
+                buffer = displayPointsJson(&words[1], count);
+                if (!buffer) { c.framesDropped++; continue; }
+            }
+        } else if (c.binary) {
+            if (!sharedBinary) {
+                uint32_t span = duration > 0xFFFFFF ? 0xFFFFFF : duration;
+                uint32_t header = merged ? (WS_FRAME_DISPLAY_MERGED | (span << 8)) : WS_FRAME_DISPLAY;
+                sharedBinary = displayFrameBuffer(header, points, n);
+            }
+            buffer = sharedBinary;
+        } else {
+            if (!sharedText) sharedText = displayPointsJson(points, n);
+            buffer = sharedText;
+            if (!buffer) { c.framesDropped++; continue; }
+        }
+        
+        unsigned long queueStart = micros();
+        size_t bytes = buffer->size();
+        if (c.binary) {
+            client->binary(buffer);
+        } else {
+            client->text(buffer);
+        }
+        displayEncodeMicros += queueStart - encodeStart;
+        displayQueueMicros += micros() - queueStart;
+        
+        c.framesSent++;
+        c.pointsSent += count;
+        c.bytesSent += bytes;
+        displayPointsSent += count;
+        displayBytesSent += bytes;
+    }
+}
+
+// Angefangenen Merge-Frame an die coalesce-Clients senden
+static void flushCoalesced() {
+    size_t count = displayCoalescer.count();
+    if (count > 0) {
+        coalesceOut += count;
+        sendDisplayFrame(displayMergedFrame, count, true, coalesceSpan);
+        coalesceSpan = 0;           // Zeit ohne Punkte geht nicht verloren
+    }
+    displayCoalescer.reset(displayMergedFrame, DISPLAY_FRAME_MAX_POINTS);
+}
+
+// Einen Punkt (dt = seine emulierte Zeit) in den Merge-Frame aufnehmen
+static void coalescePoint(uint32_t word, uint32_t dt) {
+    coalesceSpan += dt;
+    coalesceIn++;
+    if (!displayCoalescer.add(word)) {
+        flushCoalesced();
+        displayCoalescer.add(word);
+    }
+}
+
+// Nur coalesce-Clients: Ring leeren und gleiche (x,y) zusammenfassen.
+// Die dt-Felder werden dabei zur Frame-Dauer aufsummiert (inkl. Escape-Deltas).
+static void sendCoalescedPoints() {
+    static bool escape = false;     // Escape-Paar kann über Ticks verteilt sein
+    
+    const uint32_t* data;
+    size_t n;
+    while ((n = displayRing.peek(data)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            uint32_t word = data[i];
+            if (escape) {
+                escape = false;
+                coalesceSpan += word;
+                continue;
+            }
+            uint32_t dt = word >> 23;
+            if (dt == DISPLAY_DT_ESCAPE) {
+                escape = true;
+                continue;
+            }
+            if (displayClients.rasterCount() > 0) displayRaster.plot(word);
+            coalescePoint(word, dt);
+        }
+        displayRing.consume(n);
+    }
+    
+    flushCoalesced();
+}
+
+// Die vollständigen Worte eines Roh-Frames zusätzlich zusammenfassen
+// (gemischte Zuschauer: roh und coalesce gleichzeitig)
+static void coalesceRawFrame(const uint32_t* words, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t word = words[i];
+        if ((word >> 23) == DISPLAY_DT_ESCAPE) {
+            coalesceSpan += words[i + 1];   // Tripel ist im Frame immer vollständig
+            i += 2;
+            coalescePoint(words[i], 0);
+        } else {
+            coalescePoint(word, word >> 23);
+        }
+    }
+}
+
+// Ring in Frames zu max. DISPLAY_FRAME_MAX_POINTS Worten kopieren.
+// Ein Frame endet nie mitten in einem Escape-Tripel (Rest wird in
+// displayPending vorgehalten), damit jeder Client einzeln ausgedünnt
+// oder übersprungen werden kann.
+static void sendRawPoints(bool alsoCoalesce) {
+    while (true) {
+        size_t n = displayPendingCount;
+        memcpy(&displayFrame[1], displayPending, n * sizeof(uint32_t));
+        displayPendingCount = 0;
+        n += displayRing.popBulk(&displayFrame[1 + n], DISPLAY_FRAME_MAX_POINTS - n);
+        if (n == 0) break;
+        
+        uint32_t duration = 0;
+        size_t complete = 0;
+        while (complete < n) {
+            uint32_t word = displayFrame[1 + complete];
+            if ((word >> 23) == DISPLAY_DT_ESCAPE) {
+                if (complete + 2 >= n) break;
+                duration += displayFrame[2 + complete];
+                complete += 3;
+            } else {
+                duration += word >> 23;
+                complete++;
+            }
+        }
+        
+        displayPendingCount = n - complete;
+        memcpy(displayPending, &displayFrame[1 + complete], displayPendingCount * sizeof(uint32_t));
+        if (complete == 0) break;
+        if (displayClients.rasterCount() > 0) displayRaster.plotFrame(&displayFrame[1], complete);
+        sendDisplayFrame(&displayFrame[1], complete, false, duration);
+        if (alsoCoalesce) coalesceRawFrame(&displayFrame[1], complete);
+    }
+    
+    if (alsoCoalesce) flushCoalesced();
+}
+
+// Raster-Frame mit fester Bildrate: geänderte Kacheln an alle Raster-Clients,
+// Clients, die neu sind oder Frames verpasst haben, bekommen ein Vollbild.
+// Aufruf mit displayClientsMutex.
+static void sendRasterFrame() {
+    static unsigned long lastFrame = 0;
+    unsigned long now = millis();
+    if (now - lastFrame < RASTER_FRAME_MS) return;
+    lastFrame = now;
+    
+    // 0 = diesmal nichts, 1 = Änderungen, 2 = Vollbild
+    uint8_t mode[DISPLAY_MAX_CLIENTS] = { 0 };
+    bool needDiff = false;
+    bool needFull = false;
+    for (size_t i = 0; i < displayClients.count(); i++) {
+        DisplayClient& c = displayClients[i];
+        if (!c.raster) continue;
+        AsyncWebSocketClient* client = ws.client(c.id);
+        if (client == nullptr) continue;
+        size_t queue = client->queueLen();
+        if (queue > c.queueMax) c.queueMax = queue;
+        if (queue >= DISPLAY_QUEUE_SOFT) {
+            c.framesDropped++;
+            c.rasterFull = true;    // Änderungen verpasst
+            continue;
         }
-        // Wenn Mutex busy: Point verwerfen (besser als CPU zu blockieren)
+        mode[i] = c.rasterFull ? 2 : 1;
+        needFull |= c.rasterFull;
+        needDiff |= !c.rasterFull;
+    }
+    
+    for (uint8_t m = 1; m <= 2; m++) {
+        if (!(m == 1 ? needDiff : needFull)) continue;
+        displayRaster.encode(m == 2, [&](const uint8_t* data, size_t len, uint8_t flags) {
+            AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(len);
+            memcpy(buffer->data(), data, len);
+            for (size_t i = 0; i < displayClients.count(); i++) {
+                if (mode[i] != m) continue;
+                DisplayClient& c = displayClients[i];
+                AsyncWebSocketClient* client = ws.client(c.id);
+                if (client == nullptr) continue;
+                client->binary(buffer);
+                c.bytesSent += len;
+                displayBytesSent += len;
+                if (flags & RASTER_FLAG_FIRST) c.framesSent++;
+            }
+        });
+    }
+    for (size_t i = 0; i < displayClients.count(); i++) {
+        if (mode[i] == 2) displayClients[i].rasterFull = false;
     }
+    
+    displayRaster.decay();
 }
 
 // WIRD VON MAIN LOOP (CORE 0) AUFGERUFEN
 void sendDisplayPointsBatch() {
-    // MULTICORE: Buffer kopieren und dann leeren
-    std::vector<uint32_t> localBuffer;
-    
-    if (displayMutex != NULL) {
-        if (xSemaphoreTake(displayMutex, 10) == pdTRUE) {
-            localBuffer = displayBuffer;  // Kopie erstellen
-            displayBuffer.clear();         // Original leeren
-            xSemaphoreGive(displayMutex);
+    // Keiner schaut zu: Ring trotzdem leeren, sonst läuft er voll
+    if (!displayConnected || !ws.count()) {
+        const uint32_t* data;
+        size_t n;
+        while ((n = displayRing.peek(data)) > 0) {
+            displayRing.consume(n);
+        }
+        displayPendingCount = 0;
+        return;
+    }
+    
+    // Tabelle belegt (connect_dpy läuft gerade): nächster Tick
+    if (xSemaphoreTake(displayClientsMutex, 5) != pdTRUE) return;
+    
+    if (!displayRing.empty()) {
+        for (size_t i = 0; i < displayClients.count(); i++) {
+            AsyncWebSocketClient* client = ws.client(displayClients[i].id);
+            displayClients.beginTick(displayClients[i], client ? client->queueLen() : 0);
+        }
+        
+        // Jeder Client bekommt seine Art; merged allein spart das Kopieren
+        if (displayClients.coalesceCount() > 0 && displayClients.rawCount() == 0) {
+            sendCoalescedPoints();
         } else {
-            // Mutex timeout - skip this frame
-            return;
+            sendRawPoints(displayClients.coalesceCount() > 0);
         }
-    } else {
-        // Fallback ohne Mutex (sollte nicht passieren)
-        localBuffer = displayBuffer;
-        displayBuffer.clear();
+        
+        displayClients.endTick();
     }
     
-    if (localBuffer.empty()) return;
+    // Raster läuft auch ohne neue Punkte weiter (Nachleuchten)
+    if (displayClients.rasterCount() > 0 && displayRaster.isReady()) {
+        sendRasterFrame();
+    }
     
-    // JSON erstellen (ohne Mutex - arbeitet mit Kopie)
-    String json = "{\"type\":\"points\",\"points\":[";
+    xSemaphoreGive(displayClientsMutex);
+}
+
+// WIRD VON MAIN LOOP (CORE 0) AUFGERUFEN, alle PANEL_FRAME_MS
+// Jeder Panel-Client bekommt nur seine geänderten Register (webpanel.h).
+void sendPanelLamps() {
+    if (!webPanel.lockClients(0)) return;
+    if (webPanel.count() > 0) {
+        uint32_t regs[PANEL_REGS];
+        webPanel.snapshot(regs);
+        for (size_t i = 0; i < PANEL_MAX_CLIENTS; i++) {
+            PanelClient* c = webPanel.client(i);
+            if (c == nullptr) continue;
+            AsyncWebSocketClient* client = ws.client(c->id);
+            if (client == nullptr) continue;
+            if (client->queueLen() >= DISPLAY_QUEUE_SOFT) {
+                c->framesSkipped++;     // Diff bleibt offen
+                continue;
+            }
+            uint8_t frame[PANEL_FRAME_MAX];
+            size_t len = WebPanel::encodeDiff(*c, regs, frame);
+            if (len == 0) continue;
+            AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(len);
+            memcpy(buffer->data(), frame, len);
+            client->binary(buffer);
+            c->framesSent++;
+        }
+    }
+    webPanel.unlockClients();
+}
+
+// Für den Display-Benchmark (displaybench.h)
+void getDisplayPipelineStats(DisplayPipelineStats& stats) {
+    stats.ringOverflows = displayRing.getOverflows();
+    stats.pointsSent = displayPointsSent;
+    stats.bytesSent = displayBytesSent;
+    stats.encodeMicros = displayEncodeMicros;
+    stats.queueMicros = displayQueueMicros;
+    stats.pointsSkipped = 0;
+    stats.framesDropped = 0;
+    stats.clients = 0;
+    if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 100) == pdTRUE) {
+        for (size_t i = 0; i < displayClients.count(); i++) {
+            stats.pointsSkipped += displayClients[i].pointsSkipped;
+            stats.framesDropped += displayClients[i].framesDropped;
+        }
+        stats.clients = displayClients.count();
+        xSemaphoreGive(displayClientsMutex);
+    }
+}
+
+// Für 'i': Durchsatz seit dem letzten Aufruf und Heap-Verbrauch
+void printDisplayStats() {
+    static unsigned long lastTime = 0;
+    static uint32_t lastPoints = 0;
+    static uint32_t lastBytes = 0;
+    static uint32_t lastAllocs = 0;
+    static uint32_t lastAcquired = 0;
     
-    for (size_t i = 0; i < localBuffer.size(); i++) {
-        if (i > 0) json += ",";
-        json += String(localBuffer[i]);
+    unsigned long now = millis();
+    float seconds = (now - lastTime) / 1000.0f;
+    uint32_t allocs = wsBuffers.getAllocations();
+    uint32_t acquired = wsBuffers.getAcquired();
+    if (seconds > 0) {
+        Serial.printf("Display: %.0f points/s, %.1f KB/s sent\n",
+                      (displayPointsSent - lastPoints) / seconds,
+                      (displayBytesSent - lastBytes) / seconds / 1024.0f);
+        Serial.printf("WS Buffers: %.0f messages/s, %.1f heap allocs/s, %u/%u slots free, %u bytes held\n",
+                      (acquired - lastAcquired) / seconds,
+                      (allocs - lastAllocs) / seconds,
+                      (unsigned)wsBuffers.freeSlots(), (unsigned)WS_BUFFER_SLOTS,
+                      (unsigned)wsBuffers.retainedBytes());
+        Serial.printf("WS Buffers: %lu oversized (not pooled), %lu JSON messages dropped (size estimate)\n",
+                      (unsigned long)wsBuffers.getOversized(), (unsigned long)wsBuffers.getTruncated());
+    }
+    if (coalesceIn > 0) {
+        Serial.printf("Display Coalescing: %lu -> %lu points (%.1f%% sent)\n",
+                      (unsigned long)coalesceIn, (unsigned long)coalesceOut,
+                      100.0f * coalesceOut / coalesceIn);
+    }
+    if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 100) == pdTRUE) {
+        for (size_t i = 0; i < displayClients.count(); i++) {
+            DisplayClient& c = displayClients[i];
+            Serial.printf("  Client #%lu: %s, %s x%u, frames %lu sent / %lu dropped, "
+                          "points %lu sent / %lu skipped, %lu KB, max queue %u\n",
+                          (unsigned long)c.id, c.raster ? "raster" : (c.coalesce ? "merged" : (c.binary ? "binary" : "text")),
+                          displayPolicyName(c.policy), 1u << c.level,
+                          (unsigned long)c.framesSent, (unsigned long)c.framesDropped,
+                          (unsigned long)c.pointsSent, (unsigned long)c.pointsSkipped,
+                          (unsigned long)(c.bytesSent / 1024), c.queueMax);
+        }
+        xSemaphoreGive(displayClientsMutex);
+    }
+    if (displayRaster.isReady() && displayRaster.getFrames() > 0) {
+        Serial.printf("Display Raster: %lu frames, %lu tiles, %lu KB encoded, %lu us/frame\n",
+                      (unsigned long)displayRaster.getFrames(),
+                      (unsigned long)displayRaster.getTilesSent(),
+                      (unsigned long)(displayRaster.getBytesEncoded() / 1024),
+                      (unsigned long)(displayRaster.getEncodeMicros() / displayRaster.getFrames()));
     }
+    Serial.printf("Display Points dropped (ring full): %lu\n", 
+                  (unsigned long)displayRing.getOverflows());
+    Serial.printf("Min Free Heap: %d bytes\n", ESP.getMinFreeHeap());
     
-    json += "]}";
-    ws.textAll(json);
+    lastTime = now;
+    lastPoints = displayPointsSent;
+    lastBytes = displayBytesSent;
+    lastAllocs = allocs;
+    lastAcquired = acquired;
 }
 
+// ============================================================================
+// /metrics - Prometheus-Textformat
+// ============================================================================
+static void metricHeader(Print& out, const char* name, const char* type, const char* help) {
+    out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void metricValue(Print& out, const char* name, const char* type, const char* help,
+                        double value) {
+    metricHeader(out, name, type, help);
+    out.printf("%s %.6g\n", name, value);
+}
+
+static void metricStack(Print& out, const char* task, TaskHandle_t handle) {
+    if (handle) out.printf("pdp1_task_stack_free_min_bytes{task=\"%s\"} %u\n", task,
+                           (unsigned)uxTaskGetStackHighWaterMark(handle));
+}
+
+// Raten (MIPS, LED-Refresh) über die Zeit seit dem letzten Abruf
+void handleMetrics(AsyncWebServerRequest *request) {
+    static unsigned long lastTime = 0;
+    static uint32_t lastInstructions = 0;
+    static uint32_t lastLedRefreshes = 0;
+    
+    unsigned long now = millis();
+    uint32_t instructions = g_instructionsExecuted;
+    #if defined(USE_VERSION2) && !defined(WEB_PANEL_ONLY)
+        // V2: echte Matrix-Durchläufe des LED_Mux-Tasks (version2.h)
+        uint32_t ledRefreshes = metrics.ledMatrixFrames.load(std::memory_order_relaxed);
+    #else
+        uint32_t ledRefreshes = metrics.ledRefreshes.load(std::memory_order_relaxed);
+    #endif
+    float seconds = lastTime ? (now - lastTime) / 1000.0f : 0;
+    
+    AsyncResponseStream *out = request->beginResponseStream("text/plain; version=0.0.4");
+    
+    // Emulator
+    metricValue(*out, "pdp1_instructions_total", "counter", "Emulated PDP-1 instructions", instructions);
+    metricValue(*out, "pdp1_mips", "gauge", "Emulated instructions per second / 1e6 since the last scrape",
+                seconds > 0 ? (instructions - lastInstructions) / seconds / 1e6 : 0);
+    metricValue(*out, "pdp1_cpu_running", "gauge", "CPU running", cpu.isRunning() ? 1 : 0);
+    
+    // cpuMutex
+    metricHeader(*out, "pdp1_cpu_mutex_contended_total", "counter", "cpuMutex takes that had to wait");
+    metricHeader(*out, "pdp1_cpu_mutex_wait_seconds_total", "counter", "Time spent waiting for cpuMutex");
+    for (int core = 0; core < 2; core++) {
+        out->printf("pdp1_cpu_mutex_contended_total{core=\"%d\"} %lu\n", core,
+                    (unsigned long)metrics.mutexContended[core].load(std::memory_order_relaxed));
+        out->printf("pdp1_cpu_mutex_wait_seconds_total{core=\"%d\"} %.6f\n", core,
+                    metrics.mutexWaitMicros[core].load(std::memory_order_relaxed) / 1e6);
+    }
+    metricValue(*out, "pdp1_cpu_mutex_timeouts_total", "counter", "cpuMutex takes that gave up",
+                metrics.mutexTimeouts.load(std::memory_order_relaxed));
+    
+    // Display
+    uint32_t framesDropped = 0, pointsSkipped = 0;
+    if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 10) == pdTRUE) {
+        for (size_t i = 0; i < displayClients.count(); i++) {
+            framesDropped += displayClients[i].framesDropped;
+            pointsSkipped += displayClients[i].pointsSkipped;
+        }
+        xSemaphoreGive(displayClientsMutex);
+    }
+    metricValue(*out, "pdp1_display_points_produced_total", "counter", "Points plotted by the emulated Type 30",
+                cpu.getDisplayPlotted());
+    metricValue(*out, "pdp1_display_points_sent_total", "counter", "Display points sent over WebSocket",
+                displayPointsSent);
+    metricValue(*out, "pdp1_display_points_dropped_total", "counter", "Display points lost because the ring was full",
+                displayRing.getOverflows());
+    metricValue(*out, "pdp1_display_points_skipped_total", "counter", "Display points skipped by client backpressure (connected clients)",
+                pointsSkipped);
+    metricValue(*out, "pdp1_display_frames_dropped_total", "counter", "Display frames dropped by client backpressure (connected clients)",
+                framesDropped);
+    metricValue(*out, "pdp1_display_ring_depth", "gauge", "Display points waiting in the ring", displayRing.size());
+    
+    // Geräte-Queues
+    metricValue(*out, "pdp1_punch_queue_depth", "gauge", "Punched bytes waiting for core 0", punchDevice.queueDepth());
+    metricValue(*out, "pdp1_punch_overflows_total", "counter", "Punched bytes lost (queue full)", punchDevice.getOverflows());
+    metricValue(*out, "pdp1_typewriter_queue_depth", "gauge", "Typewriter characters waiting for core 0",
+                typewriterDevice.queueDepth());
+    metricValue(*out, "pdp1_typewriter_overflows_total", "counter", "Typewriter characters lost (queue full)",
+                typewriterDevice.getOverflows());
+    
+    // WebSocket (läuft im AsyncTCP-Task, wie die WS-Events)
+    metricValue(*out, "pdp1_ws_clients", "gauge", "Connected WebSocket clients", ws.count());
+    metricHeader(*out, "pdp1_ws_client_queue_length", "gauge", "Messages queued per WebSocket client");
+    for (AsyncWebSocketClient& client : ws.getClients()) {
+        out->printf("pdp1_ws_client_queue_length{client=\"%lu\"} %u\n",
+                    (unsigned long)client.id(), (unsigned)client.queueLen());
+    }
+    
+    // Speicher, Stacks
+    metricValue(*out, "pdp1_heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    metricValue(*out, "pdp1_heap_free_min_bytes", "gauge", "Heap low-water mark since boot", ESP.getMinFreeHeap());
+    metricHeader(*out, "pdp1_task_stack_free_min_bytes", "gauge", "Task stack high-water mark (unused bytes)");
+    metricStack(*out, "cpu", cpuTaskHandle);
+    metricStack(*out, "loop", xTaskGetHandle("loopTask"));
+    metricStack(*out, "async_tcp", xTaskGetCurrentTaskHandle());
+    
+    // Log-Ring (asynclog.h)
+    metricValue(*out, "pdp1_log_lines_total", "counter", "Lines written to the log ring", asyncLog.getWritten());
+    metricValue(*out, "pdp1_log_dropped_total", "counter", "Log lines dropped because the ring was full",
+                asyncLog.getDropped());
+    
+    // Start
+    metricValue(*out, "pdp1_boot_first_instruction_seconds", "gauge",
+                "Time from power-on to the first emulated instruction (0 = not yet)", g_firstInstructionMicros / 1e6);
+    metricValue(*out, "pdp1_wifi_state", "gauge", "0 off, 1 connecting, 2 waiting, 3 connected, 4 access point",
+                wifiLink.getState());
+    metricValue(*out, "pdp1_wifi_connects_total", "counter", "WiFi station connects", wifiLink.getConnects());
+    
+    // LEDs
+    #if defined(USE_VERSION2) && !defined(WEB_PANEL_ONLY)
+    metricValue(*out, "pdp1_led_refreshes_total", "counter", "Complete LED matrix scans of the multiplexer", ledRefreshes);
+    #else
+    metricValue(*out, "pdp1_led_refreshes_total", "counter", "Front panel LED updates from the CPU task", ledRefreshes);
+    #endif
+    metricValue(*out, "pdp1_led_refresh_hz", "gauge", "LED refreshes per second since the last scrape",
+                seconds > 0 ? (ledRefreshes - lastLedRefreshes) / seconds : 0);
+    
+    request->send(out);
+    
+    lastTime = now;
+    lastInstructions = instructions;
+    lastLedRefreshes = ledRefreshes;
+}
+
+// Senke für das Type 30 Display (cpu.attachDisplaySink)
+class WebDisplaySink : public IDisplaySink {
+public:
+    void plot(int16_t x, int16_t y, uint8_t intensity, uint32_t time) override {
+        handleDisplayOutput(x, y, intensity, time);
+    }
+    const char* name() const override { return "web"; }
+};
+
+WebDisplaySink webDisplaySink;
+
+// Läuft auf Core 0 unter cpuMutex - die CPU produziert dann gerade nicht,
+// der Ring hat also weiterhin nur einen Producer zur Zeit.
 void testDisplay(){
     for(int i = 0; i < 16; i++){
-        handleDisplayOutput(0,0, 7);
+        handleDisplayOutput(0,0, 7, 0);
         
-        handleDisplayOutput(-100,0, 7);
-        handleDisplayOutput(-100,100, 7);
-        handleDisplayOutput(0,100, 7);
-        handleDisplayOutput(100,100, 7);
-        handleDisplayOutput(100,0, 7);
-        handleDisplayOutput(100,-100, 7);
-        handleDisplayOutput(0,-100, 7);
-        handleDisplayOutput(-100,-100, 7);
+        handleDisplayOutput(-100,0, 7, 0);
+        handleDisplayOutput(-100,100, 7, 0);
+        handleDisplayOutput(0,100, 7, 0);
+        handleDisplayOutput(100,100, 7, 0);
+        handleDisplayOutput(100,0, 7, 0);
+        handleDisplayOutput(100,-100, 7, 0);
+        handleDisplayOutput(0,-100, 7, 0);
+        handleDisplayOutput(-100,-100, 7, 0);
         
         /*
         handleDisplayOutput(-150, 250, 7);
@@ -403,97 +1301,62 @@ void testDisplay(){
 // Paper Tape Punch Output
 // ========================================
 
-// void sendPunchData(uint8_t byte) {
-//     if (!ws.count()) return;
-    
-//     String json = "{\"type\":\"punch_data\",\"value\":" + String(byte) + "}";
-//     ws.textAll(json);
-// }
-
-// void sendPunchData(uint8_t byte) {
-//     static unsigned long lastPunch = 0;
-//     static const unsigned long PUNCH_DELAY = 10;  // 10ms = 100 cps (original speed)
-    
-//     // Warte bis genug Zeit vergangen ist (simuliert mechanischen Puncher)
-//     while (millis() - lastPunch < PUNCH_DELAY) {
-//         delay(1);
-//     }
-    
-//     if (!ws.count()) return;
-    
-//     String json = "{\"type\":\"punch_data\",\"value\":" + String(byte) + "}";
-//     ws.textAll(json);
+// WIRD VON MAIN LOOP (CORE 0) AUFGERUFEN - aus PunchDevice::service()
+// Die Bytes selbst landen auf der SD-Karte, hier nur für die Tape-Animation
+void sendPunchDataBatch(const uint8_t* data, size_t len) {
+    if (len == 0 || !ws.count()) return;
     
-//     lastPunch = millis();
-// }
-
-void sendPunchData(uint8_t byte) {
-    if (punchMutex != NULL) {
-        if (xSemaphoreTake(punchMutex, 1) == pdTRUE) {
-            punchBuffer.push_back(byte);
-            xSemaphoreGive(punchMutex);
-        }
+    WsJsonWriter json(32 + len * 4);
+    json.append("{\"type\":\"punch_batch\",\"data\":[");
+    for (size_t i = 0; i < len; i++) {
+        if (i > 0) json.appendChar(',');
+        json.appendUint(data[i]);
     }
-}
-
-void sendPunchDataBatch() {
-    std::vector<uint8_t> localBuffer;
-    
-    if (punchMutex != NULL) {
-        if (xSemaphoreTake(punchMutex, 10) == pdTRUE) {
-            localBuffer = punchBuffer;
-            punchBuffer.clear();
-            xSemaphoreGive(punchMutex);
-        } else {
-            return;
-        }
-    }
-    
-    if (localBuffer.empty() || !ws.count()) return;
-    
-    String json = "{\"type\":\"punch_batch\",\"data\":[";
-    for (size_t i = 0; i < localBuffer.size(); i++) {
-        if (i > 0) json += ",";
-        json += String(localBuffer[i]);
-    }
-    json += "]}";
-    ws.textAll(json);
+    json.append("]}");
+    AsyncWebSocketSharedBuffer buffer = json.finish();
+    if (buffer) ws.textAll(buffer);
 }
 
 // ========================================
 // Typewriter Output
 // ========================================
 
-void sendTypewriterChar(uint8_t ch) {
-    if (!ws.count()) return;
+// WIRD VON MAIN LOOP (CORE 0) AUFGERUFEN - aus TypewriterDevice::service()
+// Alle Zeichen eines Sende-Ticks als ein String. Bytes außerhalb von
+// druckbarem ASCII (Escape-Sequenzen, UTF-8) als \u00XX, der Browser
+// bekommt sie über charCodeAt() byteweise zurück.
+void sendTypewriterBatch(const uint8_t* data, size_t len) {
+    if (len == 0 || !ws.count()) return;
     
-    String json = "{\"type\":\"char\",\"value\":" + String(ch) + "}";
-    ws.textAll(json);
+    static const char hex[] = "0123456789abcdef";
+    WsJsonWriter json(32 + len * 6);
+    json.append("{\"type\":\"chars\",\"text\":\"");
+    for (size_t i = 0; i < len; i++) {
+        uint8_t ch = data[i];
+        if (ch >= 0x20 && ch < 0x7F && ch != '"' && ch != '\\') {
+            json.appendChar(ch);
+        } else {
+            json.append("\\u00");
+            json.appendChar(hex[ch >> 4]);
+            json.appendChar(hex[ch & 0xF]);
+        }
+    }
+    json.append("\"}");
+    AsyncWebSocketSharedBuffer buffer = json.finish();
+    if (buffer) ws.textAll(buffer);
 }
 
 void sendTypewriterString(const char* str) {
-    while (*str) {
-        sendTypewriterChar(*str++);
-    }
+    sendTypewriterBatch((const uint8_t*)str, strlen(str));
 }
 
+// Farbwechsel als eine Nachricht statt ein Zeichen pro Nachricht
 void setTypewriterRed() {
-    sendTypewriterChar(0x1B);
-    sendTypewriterChar('[');
-    sendTypewriterChar('3');
-    sendTypewriterChar('1');
-    sendTypewriterChar('m');
+    sendTypewriterString("\x1B[31m");
 }
 
 void setTypewriterBlack() {
-    sendTypewriterChar(0x1B);
-    sendTypewriterChar('[');
-    sendTypewriterChar('3');
-    sendTypewriterChar('9');
-    sendTypewriterChar(';');
-    sendTypewriterChar('4');
-    sendTypewriterChar('9');
-    sendTypewriterChar('m');
+    sendTypewriterString("\x1B[39;49m");
 }
 
 // ========================================
@@ -501,22 +1364,6 @@ void setTypewriterBlack() {
 // ========================================
 
 void setupWebserver() {
-    // MULTICORE: Display-Mutex erstellen
-    displayMutex = xSemaphoreCreateMutex();
-    if (displayMutex == NULL) {
-        Serial.println("[WEBSERVER] Error: Display-Mutex coul'd not create!");
-    } else {
-        Serial.println("[WEBSERVER] Display-Mutex created");
-    }
-
-    // PUNCH-MUTEX (NEU!)
-    punchMutex = xSemaphoreCreateMutex();
-    if (punchMutex == NULL) {
-        Serial.println("[WEBSERVER] Error: Punch-Mutex!");
-    } else {
-        Serial.println("[WEBSERVER] Punch-Mutex created");
-    }    
-
     // Web-Tape-Mutex erstellen
     webTapeMutex = xSemaphoreCreateMutex();
     if (webTapeMutex == NULL) {
@@ -525,11 +1372,186 @@ void setupWebserver() {
         Serial.println("[WEBSERVER] Web-Tape-Mutex created");
     }
 
+    wsBuffers.begin();
+    webPanel.begin();
+    
+    displayClientsMutex = xSemaphoreCreateMutex();
+    if (displayClientsMutex == NULL) {
+        Serial.println("[WEBSERVER] Error: Display-Clients-Mutex!");
+    }
+
     // WebSocket Handler
     ws.onEvent(onWsEvent);
     server.addHandler(&ws);
     
-    // Statische Dateien von SD-Karte servieren
+    // Gemountetes Tape für weitere Clients (Tape-Animation)
+    server.on("/tape/reader", HTTP_GET, [](AsyncWebServerRequest *request) {
+        // Die Antwort hält ihre eigene Referenz, bis sie fertig gesendet ist
+        TapeData tape = getWebTape();
+        if (!tape) {
+            request->send(404, "text/plain", "No tape mounted");
+            return;
+        }
+        request->send(request->beginResponse("application/octet-stream", tape->size(),
+            [tape](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t n = tape->size() - index;
+                if (n > maxLen) n = maxLen;
+                memcpy(buffer, tape->data() + index, n);
+                return n;
+            }));
+    });
+    
+    // Gestanzte Tapes auf der SD-Karte auflisten
+    server.on("/punch", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String json = "{\"active\":\"";
+        if (punchDevice.isTapeOpen()) json += punchDevice.getTapeName();
+        json += "\",\"tapes\":[";
+        File dir = SD.open(PUNCH_DIR);
+        bool first = true;
+        if (dir && dir.isDirectory()) {
+            while (true) {
+                File entry = dir.openNextFile();
+                if (!entry) break;
+                if (!entry.isDirectory()) {
+                    if (!first) json += ",";
+                    json += "{\"name\":\"" + String(entry.name()) + "\",\"size\":" + String((unsigned)entry.size()) + "}";
+                    first = false;
+                }
+                entry.close();
+            }
+            dir.close();
+        }
+        json += "]}";
+        request->send(200, "application/json", json);
+    });
+    
+    // Fertiges Tape direkt von der SD-Karte streamen: /punch/tape?name=tape001
+    server.on("/punch/tape", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (!request->hasParam("name")) {
+            request->send(400, "text/plain", "Missing name");
+            return;
+        }
+        String name = request->getParam("name")->value();
+        if (name.endsWith(".bin")) name = name.substring(0, name.length() - 4);
+        if (!punchDevice.isFinishedTape(name.c_str())) {
+            request->send(404, "text/plain", "No finished tape with this name");
+            return;
+        }
+        char path[48];
+        PunchDevice::tapePath(path, sizeof(path), name.c_str());
+        request->send(SD, path, "application/octet-stream", true);
+    });
+    
+    // Display-Clients mit Backpressure-Zustand und Statistik
+    server.on("/display/clients", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String json = "{\"clients\":[";
+        if (displayClientsMutex && xSemaphoreTake(displayClientsMutex, 100) == pdTRUE) {
+            for (size_t i = 0; i < displayClients.count(); i++) {
+                DisplayClient& c = displayClients[i];
+                AsyncWebSocketClient* client = ws.client(c.id);
+                if (i > 0) json += ",";
+                json += "{\"id\":" + String(c.id);
+                json += ",\"mode\":\"" + String(c.raster ? "raster" : (c.coalesce ? "merged" : (c.binary ? "binary" : "text")));
+                json += "\",\"policy\":\"" + String(displayPolicyName(c.policy));
+                json += "\",\"factor\":" + String(1u << c.level);
+                json += ",\"queue\":" + String(client ? (unsigned)client->queueLen() : 0u);
+                json += ",\"maxQueue\":" + String(c.queueMax);
+                json += ",\"framesSent\":" + String(c.framesSent);
+                json += ",\"framesDropped\":" + String(c.framesDropped);
+                json += ",\"pointsSent\":" + String(c.pointsSent);
+                json += ",\"pointsSkipped\":" + String(c.pointsSkipped);
+                json += ",\"bytesSent\":" + String(c.bytesSent) + "}";
+            }
+            xSemaphoreGive(displayClientsMutex);
+        }
+        json += "]}";
+        request->send(200, "application/json", json);
+    });
+    
+    // Kernspeicher lesen: /memory?addr=<oktal>&count=<n>&format=oct|bin
+    // Unter cpuMutex nur memcpy, die Antwort entsteht chunked aus der Kopie
+    server.on("/memory", HTTP_GET, [](AsyncWebServerRequest *request) {
+        uint32_t addr = request->hasParam("addr") ?
+            strtoul(request->getParam("addr")->value().c_str(), nullptr, 8) : 0;
+        if (addr >= EXTENDED_MEM_SIZE) {
+            request->send(400, "text/plain", "Address out of range");
+            return;
+        }
+        uint32_t count = request->hasParam("count") ?
+            request->getParam("count")->value().toInt() : EXTENDED_MEM_SIZE - addr;
+        if (count == 0 || count > EXTENDED_MEM_SIZE - addr) count = EXTENDED_MEM_SIZE - addr;
+        uint8_t format = memoryFormatFromName(
+            request->hasParam("format") ? request->getParam("format")->value().c_str() : nullptr);
+        
+        std::shared_ptr<MemorySnapshot> snapshot = std::make_shared<MemorySnapshot>();
+        if (!snapshot->reserve(count)) {
+            request->send(503, "text/plain", "Out of memory");
+            return;
+        }
+        if (!cpuMutexTake(100)) {
+            request->send(503, "text/plain", "CPU busy");
+            return;
+        }
+        snapshot->copyFrom(cpu.getMemory(), addr);
+        xSemaphoreGive(cpuMutex);
+        
+        AsyncWebServerResponse* response;
+        if (format == MEMORY_FORMAT_BIN) {
+            response = request->beginResponse("application/octet-stream", snapshot->binarySize(),
+                [snapshot](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                    return snapshot->fillBinary(buffer, maxLen, index);
+                });
+        } else {
+            response = request->beginChunkedResponse("text/plain",
+                [snapshot](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                    return snapshot->fillOctal(buffer, maxLen, index);
+                });
+        }
+        request->send(response);
+    });
+    
+    // Kernspeicher schreiben: POST /memory?addr=<oktal>&format=oct|bin
+    // Body wird beim Empfang geparst und blockweise übernommen (je Block ein Lock)
+    server.on("/memory", HTTP_POST, [](AsyncWebServerRequest *request) {
+        MemoryUpload* upload = (MemoryUpload*)request->_tempObject;
+        if (upload == nullptr) {
+            if (request->contentLength() == 0) request->send(400, "text/plain", "Empty body");
+            else request->send(500, "text/plain", "Out of memory");
+            return;
+        }
+        String written = String((unsigned long)upload->written);
+        if (upload->error == MEMORY_UPLOAD_BUSY) {
+            request->send(503, "text/plain", "CPU busy, " + written + " words written");
+            return;
+        }
+        if (upload->error != MEMORY_UPLOAD_OK) {
+            request->send(400, "text/plain",
+                          "Invalid data or address out of range, " + written + " words written");
+            return;
+        }
+        Serial.printf("[WEBSERVER] Memory upload: %lu words\n", (unsigned long)upload->written);
+        request->send(200, "application/json", "{\"written\":" + written + "}");
+    }, nullptr, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+        if (index == 0) {
+            uint32_t addr = request->hasParam("addr") ?
+                strtoul(request->getParam("addr")->value().c_str(), nullptr, 8) : 0;
+            uint8_t format = memoryFormatFromName(
+                request->hasParam("format") ? request->getParam("format")->value().c_str() : nullptr);
+            request->_tempObject = MemoryUpload::create(addr, format);   // free() durch den Server
+        }
+        MemoryUpload* upload = (MemoryUpload*)request->_tempObject;
+        if (upload == nullptr || upload->error) return;
+        upload->parse(data, len, index + len >= total, cpu.getMemory());
+    });
+    
+    // Zähler für Prometheus & Co.
+    server.on("/metrics", HTTP_GET, handleMetrics);
+    
+    // Web-Oberfläche aus dem RAM (gzip + ETag), einmal von der SD-Karte geladen
+    webAssets.begin();
+    webAssets.registerRoutes(server);
+    
+    // Alles andere weiter direkt von der SD-Karte
     server.serveStatic("/", SD, "/web/").setDefaultFile("index.html");
     
     // 404 Handler
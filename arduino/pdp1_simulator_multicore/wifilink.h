@@ -0,0 +1,158 @@
+#ifndef WIFILINK_H
+#define WIFILINK_H
+
+/*
+WIFI LINK - WLAN im Hintergrund verbinden (loop() ruft service() auf)
+Früher hat setup_wifi() gewartet, bis DHCP fertig war - ohne Netz kam
+der Simulator nie aus setup(). Jetzt startet begin() nur den Verbindungs-
+aufbau, CPU, Panel und Serial laufen sofort.
+
+  - Versuch dauert max. WIFI_CONNECT_TIMEOUT_MS, danach Pause mit
+    Backoff (1 s, 2 s, 4 s ... bis WIFI_RETRY_MAX_MS)
+  - Verbindung verloren: sofort neu verbinden, Backoff von vorn
+  - Mit WIFI_AP_FALLBACK (.ino): nach WIFI_AP_AFTER_FAILURES Fehlversuchen
+    eigenes Netz WIFI_AP_SSID aufmachen (http://192.168.4.1). Solange der
+    Access Point läuft, wird nicht mehr gesucht - der Kanalwechsel beim
+    Suchen würde die AP-Clients trennen.
+
+Der Webserver lauscht auf allen Interfaces und ist erreichbar, sobald
+eines davon eine Adresse hat.
+*/
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define WIFI_CONNECT_TIMEOUT_MS   10000
+#define WIFI_RETRY_MIN_MS         1000
+#define WIFI_RETRY_MAX_MS         60000
+#define WIFI_AP_AFTER_FAILURES    3
+#define WIFI_AP_SSID              "PDP-1"
+#define WIFI_AP_PASSWORD          "spacewar1"   // min. 8 Zeichen
+
+enum WifiLinkState : uint8_t {
+    WIFI_LINK_OFF = 0,
+    WIFI_LINK_CONNECTING,
+    WIFI_LINK_WAITING,      // Pause bis zum nächsten Versuch
+    WIFI_LINK_CONNECTED,
+    WIFI_LINK_AP            // eigener Access Point
+};
+
+class WifiLink {
+private:
+    const char* ssid;
+    const char* password;
+    WifiLinkState state;
+    unsigned long attemptStart;
+    unsigned long nextAttempt;
+    uint32_t backoff;
+    uint8_t failures;           // Fehlversuche seit der letzten Verbindung
+    uint32_t connects;
+    unsigned long firstLinkMillis;
+
+    void startAttempt() {
+        WiFi.disconnect();
+        WiFi.begin(ssid, password);
+        attemptStart = millis();
+        state = WIFI_LINK_CONNECTING;
+    }
+
+    void linkUp(const char* what, IPAddress ip) {
+        if (firstLinkMillis == 0) firstLinkMillis = millis();
+        Serial.printf("[WIFI] %s, IP %s (%lu ms after power-on)\n",
+                      what, ip.toString().c_str(), millis());
+    }
+
+    void startAccessPoint() {
+        WiFi.mode(WIFI_AP);
+        if (WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASSWORD)) {
+            state = WIFI_LINK_AP;
+            linkUp("Access point " WIFI_AP_SSID " started", WiFi.softAPIP());
+        } else {
+            Serial.println("[WIFI] Access point failed");
+            WiFi.mode(WIFI_STA);
+            state = WIFI_LINK_WAITING;
+            nextAttempt = millis() + backoff;
+        }
+    }
+
+public:
+    WifiLink() : ssid(nullptr), password(nullptr), state(WIFI_LINK_OFF), attemptStart(0),
+                 nextAttempt(0), backoff(WIFI_RETRY_MIN_MS), failures(0), connects(0),
+                 firstLinkMillis(0) {}
+
+    // Kehrt sofort zurück; initialisiert den Netzwerk-Stack, damit der
+    // Webserver danach schon starten kann
+    void begin(const char* ssid, const char* password) {
+        this->ssid = ssid;
+        this->password = password;
+        WiFi.mode(WIFI_STA);
+        WiFi.setAutoReconnect(false);   // Wiederholen macht service()
+        Serial.printf("[WIFI] Connecting to %s in the background\n", ssid);
+        startAttempt();
+    }
+
+    // Aus loop() (Core 0), kostet nur einen Status-Abruf
+    void service() {
+        switch (state) {
+            case WIFI_LINK_CONNECTING:
+                if (WiFi.status() == WL_CONNECTED) {
+                    state = WIFI_LINK_CONNECTED;
+                    failures = 0;
+                    backoff = WIFI_RETRY_MIN_MS;
+                    connects++;
+                    linkUp("Connected", WiFi.localIP());
+                } else if (millis() - attemptStart >= WIFI_CONNECT_TIMEOUT_MS) {
+                    failures++;
+                    #ifdef WIFI_AP_FALLBACK
+                        if (failures >= WIFI_AP_AFTER_FAILURES) {
+                            Serial.printf("[WIFI] %s not reachable, opening access point\n", ssid);
+                            startAccessPoint();
+                            break;
+                        }
+                    #endif
+                    Serial.printf("[WIFI] No connection, retry in %lu s\n", (unsigned long)(backoff / 1000));
+                    WiFi.disconnect();
+                    state = WIFI_LINK_WAITING;
+                    nextAttempt = millis() + backoff;
+                    backoff = backoff * 2 > WIFI_RETRY_MAX_MS ? WIFI_RETRY_MAX_MS : backoff * 2;
+                }
+                break;
+
+            case WIFI_LINK_WAITING:
+                if ((long)(millis() - nextAttempt) >= 0) startAttempt();
+                break;
+
+            case WIFI_LINK_CONNECTED:
+                if (WiFi.status() != WL_CONNECTED) {
+                    Serial.println("[WIFI] Connection lost, reconnecting");
+                    startAttempt();
+                }
+                break;
+
+            case WIFI_LINK_OFF:
+            case WIFI_LINK_AP:
+                break;
+        }
+    }
+
+    bool isUp() const { return state == WIFI_LINK_CONNECTED || state == WIFI_LINK_AP; }
+    WifiLinkState getState() const { return state; }
+    uint32_t getConnects() const { return connects; }
+    unsigned long getFirstLinkMillis() const { return firstLinkMillis; }
+
+    void printStatus() const {
+        static const char* names[] = { "off", "connecting", "waiting", "connected", "access point" };
+        Serial.printf("WiFi: %s", names[state]);
+        if (state == WIFI_LINK_CONNECTED) {
+            Serial.printf(" (%s, %d dBm)", WiFi.localIP().toString().c_str(), WiFi.RSSI());
+        } else if (state == WIFI_LINK_AP) {
+            Serial.printf(" (%s, %d clients)", WiFi.softAPIP().toString().c_str(), WiFi.softAPgetStationNum());
+        }
+        Serial.printf(", %lu connects, first link after %lu ms\n",
+                      (unsigned long)connects, firstLinkMillis);
+    }
+};
+
+WifiLink wifiLink;
+
+#endif // WIFILINK_H
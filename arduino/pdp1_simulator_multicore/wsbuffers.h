@@ -0,0 +1,192 @@
+#ifndef WSBUFFERS_H
+#define WSBUFFERS_H
+
+/*
+WEBSOCKET BROADCAST BUFFERS
+Jede Broadcast-Nachricht wird genau einmal in einen Puffer geschrieben
+und als AsyncWebSocketSharedBuffer (std::shared_ptr, referenzgezählt) an
+alle Clients gehängt - keine Kopie pro Client, kein String.
+
+Die Puffer kommen aus einem festen Pool. Ein Slot ist frei, sobald keine
+Client-Queue ihn mehr hält (use_count() == 1, nur noch der Pool). Einmal
+gewachsene Slots behalten ihre Kapazität, im Dauerbetrieb wird also
+nichts mehr allokiert. Nur wenn alle Slots unterwegs sind oder ein Slot
+wachsen muss, gibt es eine Heap-Allokation - die wird gezählt ('i').
+
+Zwei Größenklassen: kleine Slots (Status, Messages, Typewriter) und
+wenige große für Display-Frames. Ein Slot behält höchstens
+WS_BUFFER_KEEP_MAX Bytes (ein voller Binär-Frame): größere Nachrichten,
+z.B. der JSON-Fallback eines vollen Frames (~22 KB), bekommen einen
+eigenen Puffer, der mit der letzten Client-Queue wieder frei wird. Der
+Pool hält damit nie mehr als WS_BUFFER_LARGE_SLOTS x WS_BUFFER_KEEP_MAX
+(+ die kleinen Slots) fest - 'i' zeigt den tatsächlichen Wert.
+
+Die Slot-Zahlen sind geschätzt, nicht unter Last auf der Hardware
+gemessen - 'i' (Allokationen/s, freie Slots, gehaltene Bytes) ist die
+Grundlage, um sie nachzustellen.
+
+Wird aus mehreren Tasks benutzt (loop, AsyncTCP, CPU-Task): die Suche
+nach einem freien Slot läuft in einer Critical Section.
+*/
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include <vector>
+
+#define WS_BUFFER_SMALL_SLOTS  16
+#define WS_BUFFER_LARGE_SLOTS  8
+#define WS_BUFFER_SLOTS        (WS_BUFFER_SMALL_SLOTS + WS_BUFFER_LARGE_SLOTS)
+#define WS_BUFFER_SMALL_MAX    1024   // größere Nachrichten -> große Slots
+#define WS_BUFFER_INITIAL      256    // Startkapazität kleiner Slots
+#define WS_BUFFER_KEEP_MAX     (8 * 1024 + 64)   // mehr behält ein Slot nicht
+
+class WsBufferPool {
+private:
+    AsyncWebSocketSharedBuffer slots[WS_BUFFER_SLOTS];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    volatile uint32_t allocations;  // Heap-Allokationen seit Start
+    volatile uint32_t acquired;     // ausgegebene Puffer seit Start
+    volatile uint32_t oversized;    // zu groß für den Pool, einzeln allokiert
+    volatile uint32_t truncated;    // WsJsonWriter: Schätzung zu klein, nicht gesendet
+
+public:
+    WsBufferPool() : allocations(0), acquired(0), oversized(0), truncated(0) {}
+
+    // In setup() aufrufen, bevor die erste Nachricht gesendet wird
+    void begin() {
+        for (size_t i = 0; i < WS_BUFFER_SLOTS; i++) {
+            slots[i] = std::make_shared<std::vector<uint8_t>>();
+            if (i < WS_BUFFER_SMALL_SLOTS) slots[i]->reserve(WS_BUFFER_INITIAL);
+        }
+    }
+
+    // Puffer mit size() == len. Kleinster freier Slot der Größenklasse,
+    // der passt; sonst der größte freie Slot (wächst einmalig).
+    AsyncWebSocketSharedBuffer acquire(size_t len) {
+        AsyncWebSocketSharedBuffer buffer;
+        if (len > WS_BUFFER_KEEP_MAX) {
+            // Würde einen Slot dauerhaft aufblähen - einmaliger Puffer
+            allocations++;
+            oversized++;
+            acquired++;
+            return std::make_shared<std::vector<uint8_t>>(len);
+        }
+        int from = (len <= WS_BUFFER_SMALL_MAX) ? 0 : WS_BUFFER_SMALL_SLOTS;
+        int to = (len <= WS_BUFFER_SMALL_MAX) ? WS_BUFFER_SMALL_SLOTS : WS_BUFFER_SLOTS;
+
+        portENTER_CRITICAL(&lock);
+        int best = -1;
+        int any = -1;
+        for (int i = from; i < to; i++) {
+            if (!slots[i] || slots[i].use_count() != 1) continue;
+            size_t capacity = slots[i]->capacity();
+            if (capacity >= len) {
+                if (best < 0 || capacity < slots[best]->capacity()) best = i;
+            } else if (any < 0 || capacity > slots[any]->capacity()) {
+                any = i;
+            }
+        }
+        if (best < 0) best = any;
+        if (best >= 0) buffer = slots[best];    // use_count 2: für andere belegt
+        acquired++;
+        portEXIT_CRITICAL(&lock);
+
+        if (!buffer) {
+            // Alle Slots stecken noch in Client-Queues
+            allocations++;
+            return std::make_shared<std::vector<uint8_t>>(len);
+        }
+        if (buffer->capacity() < len) {
+            allocations++;
+        }
+        buffer->resize(len);
+        return buffer;
+    }
+
+    uint32_t getAllocations() const { return allocations; }
+    uint32_t getAcquired() const { return acquired; }
+    uint32_t getOversized() const { return oversized; }
+    uint32_t getTruncated() const { return truncated; }
+    void countTruncated() { truncated++; }
+
+    // Kapazität aller Slots = Heap, den der Pool festhält
+    size_t retainedBytes() {
+        size_t bytes = 0;
+        portENTER_CRITICAL(&lock);
+        for (size_t i = 0; i < WS_BUFFER_SLOTS; i++) {
+            if (slots[i]) bytes += slots[i]->capacity();
+        }
+        portEXIT_CRITICAL(&lock);
+        return bytes;
+    }
+
+    size_t freeSlots() {
+        size_t count = 0;
+        portENTER_CRITICAL(&lock);
+        for (size_t i = 0; i < WS_BUFFER_SLOTS; i++) {
+            if (slots[i] && slots[i].use_count() == 1) count++;
+        }
+        portEXIT_CRITICAL(&lock);
+        return count;
+    }
+};
+
+WsBufferPool wsBuffers;
+
+// JSON direkt in einen Pool-Puffer schreiben. Vorher die maximale Länge
+// abschätzen, am Ende wird der Puffer auf die echte Länge gekürzt
+// (ohne Realloc). Reicht die Schätzung nicht, liefert finish() einen
+// leeren Zeiger - abgeschnittenes JSON wird nie gesendet.
+class WsJsonWriter {
+private:
+    AsyncWebSocketSharedBuffer buffer;
+    char* out;
+    size_t len;
+    size_t max;
+    bool overflow;
+
+public:
+    explicit WsJsonWriter(size_t maxLen) {
+        buffer = wsBuffers.acquire(maxLen);
+        out = (char*)buffer->data();
+        len = 0;
+        max = maxLen;
+        overflow = false;
+    }
+
+    void append(const char* text) {
+        while (*text) appendChar(*text++);
+    }
+
+    void appendUint(uint32_t value) {
+        char digits[10];
+        int n = 0;
+        do {
+            digits[n++] = '0' + value % 10;
+            value /= 10;
+        } while (value);
+        while (n > 0) appendChar(digits[--n]);
+    }
+
+    void appendChar(char c) {
+        if (len < max) {
+            out[len++] = c;
+        } else {
+            overflow = true;
+        }
+    }
+
+    // nullptr = Schätzung zu klein, Nachricht verwerfen
+    AsyncWebSocketSharedBuffer finish() {
+        if (overflow) {
+            wsBuffers.countTruncated();
+            return AsyncWebSocketSharedBuffer();
+        }
+        buffer->resize(len);
+        return buffer;
+    }
+};
+
+#endif // WSBUFFERS_H
@@ -0,0 +1,129 @@
+#ifndef WSCOMMANDS_H
+#define WSCOMMANDS_H
+
+/*
+WEBSOCKET COMMANDS - binäres Kommando-Protokoll (Browser -> ESP32)
+Ein Binär-Frame = 1 Byte Opcode + Nutzdaten (Zahlen little-endian).
+JSON-Text-Frames ({"type":...}) werden weiter verstanden, nur noch für
+ältere Clients. Beide Wege rufen dieselben Kommandos in webserver.h auf.
+
+  0x01 KEY             ASCII (1)
+  0x02 PANEL_SWITCH    Reihe (1: 0 Adresse, 1 Test Word, 2 Toggles), Wert (4)
+  0x03 PANEL_FLIP      Reihe (1), Bit (1)
+  0x04 PANEL_BUTTON    PANEL_BUTTON_* Maske (1)
+  0x05 CONNECT_DPY     Flags (1: Bit 0 binär, Bit 1 coalesce, Bit 2 raster), Policy (1)
+  0x06 DISCONNECT_DPY
+  0x07 CONNECT_PANEL
+  0x08 DISCONNECT_PANEL
+  0x10 MOUNT_BEGIN     Größe (4)
+  0x11 TAPE_CHUNK      Tape-Daten (Rest des Frames, darf fragmentiert ankommen)
+  0x12 UNMOUNT
+  0x13 PUNCH_NEW       Name (Rest des Frames, ohne NUL)
+  0x14 PUNCH_FINISH
+  0x20 CPU_RUN
+  0x21 CPU_STOP
+  0x22 CPU_STEP
+  0x23 CPU_RESET
+  0x24 EXAMINE         Adresse (2), Anzahl (1, max. 64) -> Antwort
+  0x25 DEPOSIT         Adresse (2), Wert (4)
+  0x26 STATE           -> Antwort
+
+Antworten (binär, Typ 0x05):
+  EXAMINE  0x05, 0x24, Adresse (2), Anzahl (1), Worte (je 4)
+  STATE    0x05, 0x26, PC (2), AC (4), IO (4), Flags (1: Bit 0 läuft, Bit 1 Overflow)
+
+Für 'i' wird pro Weg gezählt: Kommandos, Zeit (Mittel/Max) und die
+Stack-Tiefe im AsyncTCP-Task vom Event-Handler bis in den Dispatcher.
+*/
+
+#include <Arduino.h>
+
+#define WS_FRAME_DEBUG           0x05   // Antworten auf Debugger-Kommandos
+
+#define WS_CMD_KEY               0x01
+#define WS_CMD_PANEL_SWITCH      0x02
+#define WS_CMD_PANEL_FLIP        0x03
+#define WS_CMD_PANEL_BUTTON      0x04
+#define WS_CMD_CONNECT_DPY       0x05
+#define WS_CMD_DISCONNECT_DPY    0x06
+#define WS_CMD_CONNECT_PANEL     0x07
+#define WS_CMD_DISCONNECT_PANEL  0x08
+#define WS_CMD_MOUNT_BEGIN       0x10
+#define WS_CMD_TAPE_CHUNK        0x11
+#define WS_CMD_UNMOUNT           0x12
+#define WS_CMD_PUNCH_NEW         0x13
+#define WS_CMD_PUNCH_FINISH      0x14
+#define WS_CMD_CPU_RUN           0x20
+#define WS_CMD_CPU_STOP          0x21
+#define WS_CMD_CPU_STEP          0x22
+#define WS_CMD_CPU_RESET         0x23
+#define WS_CMD_EXAMINE           0x24
+#define WS_CMD_DEPOSIT           0x25
+#define WS_CMD_STATE             0x26
+
+#define WS_EXAMINE_MAX           64
+#define WS_JSON_DOC_SIZE         384    // größte Nachricht: connect_dpy / punch_new
+
+#define WS_DPY_FLAG_BINARY       0x01
+#define WS_DPY_FLAG_COALESCE     0x02
+#define WS_DPY_FLAG_RASTER       0x04
+
+static inline uint16_t wsRead16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t wsRead32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void wsWrite16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline void wsWrite32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+// Kosten pro Protokoll (nur AsyncTCP-Task schreibt)
+struct WsCommandStats {
+    uint32_t commands;
+    uint32_t errors;
+    uint32_t totalMicros;
+    uint32_t maxMicros;
+    uint32_t maxStack;      // Bytes zwischen onWsEvent und Dispatcher
+
+    void record(unsigned long start, uint32_t stack) {
+        uint32_t t = micros() - start;
+        commands++;
+        totalMicros += t;
+        if (t > maxMicros) maxMicros = t;
+        if (stack > maxStack) maxStack = stack;
+    }
+
+    void print(const char* name) const {
+        Serial.printf("WS %-6s %lu commands, %lu errors, avg %lu us, max %lu us, stack %lu bytes\n",
+                      name, (unsigned long)commands, (unsigned long)errors,
+                      commands ? (unsigned long)(totalMicros / commands) : 0UL,
+                      (unsigned long)maxMicros, (unsigned long)maxStack);
+    }
+};
+
+// Stack-Tiefe messen: onWsEvent merkt sich seinen Frame, der Dispatcher
+// ruft wsStackDepth() auf - der Abstand enthält dessen ganzen Frame
+// (beim JSON-Weg also auch das JsonDocument).
+static uintptr_t wsStackBase = 0;
+
+static void __attribute__((noinline)) wsMarkStack() {
+    wsStackBase = (uintptr_t)__builtin_frame_address(0);
+}
+
+static uint32_t __attribute__((noinline)) wsStackDepth() {
+    uintptr_t here = (uintptr_t)__builtin_frame_address(0);
+    return wsStackBase > here ? wsStackBase - here : 0;
+}
+
+#endif // WSCOMMANDS_H
@@ -1,19 +1,35 @@
 class p7sim {
 	constructor(canvas) {
 		this.canvas = canvas;
-		this.initGL();
 
-		this.time = 0;
-		this.points = [];
-		this.newpoints = [];
+		this.time = 0;              // emulierte Zeit (µs) des zuletzt empfangenen Punkts
+		this.renderTime = 0;        // emulierte Zeit, die gerade angezeigt wird
+		this.maxLag = 100000;       // Jitter-Puffer: max. 100 ms hinter this.time
+		this.lastFrame = performance.now();
+		this.lastArrival = 0;
+
+		// Punkte-Ring, einmal angelegt: pro Punkt x, y, Geburtszeit, Intensität.
+		// Die Geburtszeit steht modulo 2^24 µs im Float (exakt), das Alter
+		// rechnet der Shader aus u_now - Geburt. Hochgeladen wird nur, was
+		// seit dem letzten Frame neu ist (bufferSubData).
+		this.capacity = 1 << 18;                 // 262144 Punkte
+		this.vertices = new Float32Array(this.capacity * 4);
+		this.births = new Float64Array(this.capacity);  // volle Zeit, für tail
+		this.head = 0;       // nächster freier Platz (fortlaufend gezählt)
+		this.tail = 0;       // ältester noch sichtbarer Punkt
+		this.uploaded = 0;   // bis hier liegt der Ring auf der GPU
+		this.maxAge = 200000;
 //		this.indices = Array(1024*1024).fill(-1);
 
 		this.frameInterval = 33333; // ~30 FPS
+		this.pointsReceived = 0;    // Statistik, wird von index.html abgefragt
 
 		this.pointSize = 2.0;
 
 		// for point processing
 		this.esc = false;
+
+		this.initGL();
 	}
 
 	initGL() {
@@ -30,6 +46,8 @@ class p7sim {
 		this.initShaders();
 		this.initFramebuffers();
 		this.pointBuffer = this.gl.createBuffer();
+		this.gl.bindBuffer(this.gl.ARRAY_BUFFER, this.pointBuffer);
+		this.gl.bufferData(this.gl.ARRAY_BUFFER, this.capacity * 16, this.gl.DYNAMIC_DRAW);
 
 		this.gl.clearColor(0, 0, 0, 1);
 		this.gl.clear(this.gl.COLOR_BUFFER_BIT);
@@ -41,8 +59,20 @@ attribute vec4 in_pos;
 varying float v_intensity;
 varying float v_fade;
 uniform float u_pointSize;
+uniform float u_now;
+uniform float u_maxAge;
 void main() {
-	v_fade = pow(0.5, in_pos.z);
+	// in_pos.z = Geburtszeit mod 2^24 µs
+	float age = mod(u_now - in_pos.z + 16777216.0, 16777216.0);
+	if(age > u_maxAge) {
+		// abgeklungen oder noch im Jitter-Puffer (Geburt in der Zukunft)
+		gl_Position = vec4(2.0, 2.0, 0, 1);
+		gl_PointSize = 0.0;
+		v_fade = 0.0;
+		v_intensity = 0.0;
+		return;
+	}
+	v_fade = pow(0.5, age / 50000.0);
 	float sz = mix(0.0018, 0.0055, in_pos.w)*1024.0/2.0;
 	v_intensity = mix(0.25, 1.0, in_pos.w);
 	gl_Position = vec4((in_pos.xy / 512.0) - 1.0, 0, 1);
@@ -122,7 +152,7 @@ void main() {
 			return { prog: prog, locs: locs };
 		};
 
-		this.pointProg = progAndLocs(point_vs, point_fs, ["in_pos"], ["u_pointSize"]);
+		this.pointProg = progAndLocs(point_vs, point_fs, ["in_pos"], ["u_pointSize", "u_now", "u_maxAge"]);
 		this.exciteProg = progAndLocs(vs, excite_fs, ["in_pos", "in_uv"], ["tex0", "tex1"]);
 		this.combineProg = progAndLocs(vs, combine_fs, ["in_pos", "in_uv"], ["tex0", "tex1"]);
 
@@ -234,82 +264,112 @@ void main() {
 		gl.bufferData(gl.ARRAY_BUFFER, quadVertices, gl.STATIC_DRAW);
 	}
 
-	processIncoming(data) {
-		for (let i = 0; i < data.length; i++) {
-			const cmd = data[i];
-			
-			let x = cmd & 0o1777;
-			let y = (cmd >> 10) & 0o1777;
-			const intensity = (cmd >> 20) & 7;
-			const dt = (cmd >> 23) & 0o777;
-			
-			this.time += dt;
-			
-			if(x != 0 || y != 0) {
-				this.newpoints.push({
-					x: x,
-					y: y,
-					intensity: intensity,
-					age: 0  // Frischer Punkt, age = 0
-				});
-			}
-		}
-		
-		// KEIN process() und draw() hier!
-		// Das macht der drawLoop() kontinuierlich
+	// Punkt in den Ring schreiben - keine Objekte, kein GC
+	addPoint(x, y, intensity, born) {
+		const idx = this.head & (this.capacity - 1);
+		const v = idx * 4;
+		this.vertices[v + 0] = x;
+		this.vertices[v + 1] = y;
+		this.vertices[v + 2] = born % 16777216;
+		this.vertices[v + 3] = intensity / 7.0;
+		this.births[idx] = born;
+		this.head++;
+		// Ring voll: ältesten Punkt überschreiben
+		if(this.head - this.tail > this.capacity)
+			this.tail = this.head - this.capacity;
+		if(this.head - this.uploaded > this.capacity)
+			this.uploaded = this.head - this.capacity;
 	}
 
-//old
-/*
+	// data: Array (Text-JSON) oder Uint32Array (Binär-Frame)
+	// dt (Bits 23-31) = emulierte µs seit dem vorigen Punkt,
+	// dt == 511: Escape, das nächste Wort ist das volle Delta
 	processIncoming(data) {
-		
+		this.pointsReceived += data.length;
+		this.lastArrival = performance.now();
+
 		for (let i = 0; i < data.length; i++) {
 			const cmd = data[i];
-			const dt = (cmd >> 23) & 0o777;
 
 			// escape for longer delays of nothing
 			if(this.esc) {
 				this.esc = false;
 				this.time += cmd;
-			} else if(dt == 511) {
-				this.esc = true;
-			} else {
-				const x = cmd & 0o1777;
-				const y = (cmd >> 10) & 0o1777;
-				const intensity = (cmd >> 20) & 7;
-
-				this.time += dt;
-
-				if(x != 0 || y != 0)
-					this.newpoints.push({
-						x: x,
-						y: y,
-						intensity: intensity,
-						age: this.frameInterval - this.time
-					});
+				continue;
 			}
 
-			while(this.time >= this.frameInterval) {
-				this.time -= this.frameInterval;
-				this.process();
-				this.draw();
+			const dt = (cmd >>> 23) & 0o777;
+			if(dt == 511) {
+				this.esc = true;
+				continue;
 			}
+
+			const x = cmd & 0o1777;
+			const y = (cmd >> 10) & 0o1777;
+			const intensity = (cmd >> 20) & 7;
+
+			this.time += dt;
+
+			if(x != 0 || y != 0)
+				this.addPoint(x, y, intensity, this.time);
 		}
-	}*/
+		
+		// KEIN process() und draw() hier!
+		// Das macht der drawLoop() kontinuierlich
+	}
 
-	process() {
-		// TODO?: indices
+	// Zusammengefasste Punkte (ESP32 coalescing): Bits 20-22 = hellste
+	// Intensität, Bits 23-31 = Treffer. Die Frame-Dauer span (µs) wird in
+	// Reihenfolge des ersten Auftretens auf die Punkte verteilt. Mehrere
+	// Treffer werden mehrfach gezeichnet (additives Blending), damit ein
+	// oft geplotteter Punkt heller bleibt - höchstens MERGED_MAX_COPIES mal.
+	processMerged(data, span) {
+		const MERGED_MAX_COPIES = 4;
+		this.pointsReceived += data.length;
+		this.lastArrival = performance.now();
+
+		const start = this.time;
+		for (let i = 0; i < data.length; i++) {
+			const cmd = data[i];
+			const x = cmd & 0o1777;
+			const y = (cmd >> 10) & 0o1777;
+			const intensity = (cmd >> 20) & 7;
+			const copies = Math.min(Math.max((cmd >>> 23) & 0o777, 1), MERGED_MAX_COPIES);
 
-		let points = [];
-		for(let p of this.points) {
-			p.age += this.frameInterval;
-			if(p.age < 200000)
-				points.push(p);
+			if(x != 0 || y != 0)
+				for (let c = 0; c < copies; c++)
+					this.addPoint(x, y, intensity, start + span * (i + 1) / data.length);
 		}
-		this.points = points;
+		this.time = start + span;
+	}
 
-		this.points.push(...this.newpoints);
-		this.newpoints = [];
+	// Punkte altern in emulierter Zeit, nicht nach Ankunft über WiFi.
+	// renderTime läuft mit der Wanduhr, bleibt aber zwischen
+	// this.time - maxLag und this.time - so glättet sie Netzwerk-Jitter.
+	// Das Abklingen selbst rechnet der Shader, hier wird nur tail nachgezogen.
+	process() {
+		const now = performance.now();
+		const wall = (now - this.lastFrame) * 1000;
+		this.lastFrame = now;
+
+		// CPU plottet nichts (gestoppt): Phosphor klingt trotzdem ab
+		if(now - this.lastArrival > 200)
+			this.time += wall;
+
+		this.renderTime += wall;
+		if(this.renderTime > this.time)
+			this.renderTime = this.time;
+		if(this.renderTime < this.time - this.maxLag)
+			this.renderTime = this.time - this.maxLag;
+
+		// Geburtszeiten sind im Ring aufsteigend: abgeklungene vorne abschneiden
+		const mask = this.capacity - 1;
+		while(this.tail < this.head && this.renderTime - this.births[this.tail & mask] > this.maxAge)
+			this.tail++;
+	}
+
+	get liveCount() {
+		return this.head - this.tail;
 	}
 
 	draw() {
@@ -335,6 +395,19 @@ void main() {
 		this.flip = 1 - this.flip;
 	}
 
+	// Neue Ring-Einträge seit dem letzten Frame auf die GPU (max. 2 Stücke)
+	uploadNew() {
+		const gl = this.gl;
+		const mask = this.capacity - 1;
+		while(this.uploaded < this.head) {
+			const start = this.uploaded & mask;
+			const count = Math.min(this.head - this.uploaded, this.capacity - start);
+			gl.bufferSubData(gl.ARRAY_BUFFER, start * 16,
+				this.vertices.subarray(start * 4, (start + count) * 4));
+			this.uploaded += count;
+		}
+	}
+
 	drawWhite(fbo) {
 		const gl = this.gl;
 
@@ -350,25 +423,24 @@ void main() {
 		gl.useProgram(prog);
 
 		gl.uniform1f(locs.u_pointSize, this.pointSize);
-
-		const nverts = this.points.length;
-
-		const positions = new Float32Array(nverts * 4);
-		for (let i = 0; i < nverts; i++) {
-			const point = this.points[i];
-			positions[i*4 + 0] = point.x;
-			positions[i*4 + 1] = point.y;
-			positions[i*4 + 2] = point.age / 50000.0;
-			positions[i*4 + 3] = point.intensity/7.0;
-		}
+		gl.uniform1f(locs.u_now, this.renderTime % 16777216);
+		gl.uniform1f(locs.u_maxAge, this.maxAge);
 
 		gl.bindBuffer(gl.ARRAY_BUFFER, this.pointBuffer);
-		gl.bufferData(gl.ARRAY_BUFFER, positions, gl.DYNAMIC_DRAW);
+		this.uploadNew();
 
 		gl.enableVertexAttribArray(locs.in_pos);
 		gl.vertexAttribPointer(locs.in_pos, 4, gl.FLOAT, false, 0, 0);
 
-		gl.drawArrays(gl.POINTS, 0, nverts);
+		// lebende Punkte [tail, head), ggf. über das Ring-Ende hinweg
+		const mask = this.capacity - 1;
+		const first = this.tail & mask;
+		const count = this.head - this.tail;
+		const part1 = Math.min(count, this.capacity - first);
+		if(part1 > 0)
+			gl.drawArrays(gl.POINTS, first, part1);
+		if(count > part1)
+			gl.drawArrays(gl.POINTS, 0, count - part1);
 	}
 
 	composePass(fbo, tex0, tex1, prog) {
@@ -23,7 +23,7 @@ class Typewriter {
 
 		if(code >= 0) {
 	//		console.log("typed", key, code);
-			ws.send(JSON.stringify({ type: 'key', value: code&0o377 }));
+			sendCommand(WS_CMD.KEY, [code&0o377]);
 		}
 	}
 
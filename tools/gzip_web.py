@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""
+gzip_web.py - Web-Dateien für die SD-Karte vorkomprimieren
+
+Schreibt zu jeder Datei in sd_card/web/ eine .gz-Version daneben. Der
+Simulator lädt beim Start bevorzugt die .gz-Dateien in den RAM
+(webassets.h) und schickt sie mit Content-Encoding: gzip.
+
+Die Ausgabe ist reproduzierbar (kein Zeitstempel im gzip-Header), das ETag
+ändert sich also nur, wenn sich der Inhalt ändert.
+
+Aufruf (im Repository-Root):
+    python3 tools/gzip_web.py [verzeichnis]
+"""
+
+import gzip
+import os
+import sys
+
+EXTENSIONS = ('.html', '.js', '.css', '.json', '.svg')
+
+
+def compress(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    packed = gzip.compress(data, compresslevel=9, mtime=0)
+    with open(path + '.gz', 'wb') as f:
+        f.write(packed)
+    return len(data), len(packed)
+
+
+def main():
+    web_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join('sd_card', 'web')
+    if not os.path.isdir(web_dir):
+        print(f"Verzeichnis nicht gefunden: {web_dir}")
+        return 1
+
+    total_in = 0
+    total_out = 0
+    for name in sorted(os.listdir(web_dir)):
+        path = os.path.join(web_dir, name)
+        if not os.path.isfile(path) or not name.endswith(EXTENSIONS):
+            continue
+        size_in, size_out = compress(path)
+        total_in += size_in
+        total_out += size_out
+        print(f"{name:20s} {size_in:7d} -> {size_out:6d} bytes")
+
+    print(f"{'gesamt':20s} {total_in:7d} -> {total_out:6d} bytes")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
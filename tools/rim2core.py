@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+rim2core.py - RIM-Tapes in Core-Images für den Flash umwandeln
+
+Liest alle programs/*.rim, führt den RIM-Ladevorgang (Hardware RIM-Mode +
+Block-Loader bei 7751) offline aus und schreibt die belegten Speicherworte
+als constexpr-Arrays nach arduino/pdp1_simulator_multicore/core_images.h.
+
+Der Simulator kann diese Programme dann ohne SD-Karte und ohne emulierten
+RIM-Load direkt in den Speicher kopieren (coreimage.h). Gewählt wird ein
+Image beim READ IN über eine Marker-Datei <name>.core im Ordner der Sense
+Switches, per Serial 'c' oder per BOOT_PROGRAM.
+
+Aufruf (im Repository-Root):
+    python3 tools/rim2core.py [programs] [ausgabe.h]
+"""
+
+import os
+import re
+import sys
+
+WORD_MASK = 0o777777
+RIM_END_MARKER = 0o607751
+
+
+def read_words(data):
+    # Wie PaperTapeStream::readWord(): nur Bytes mit Bit 7, je 6 Bit
+    words = []
+    word = 0
+    count = 0
+    for byte in data:
+        if byte & 0x80:
+            word = (word << 6) | (byte & 0x3F)
+            count += 1
+            if count == 3:
+                words.append(word & WORD_MASK)
+                word = 0
+                count = 0
+    return words
+
+
+def ones_add(a, b):
+    s = a + b
+    if s > WORD_MASK:
+        s = (s + 1) & WORD_MASK
+    return s
+
+
+def load_rim(words, name):
+    """Gibt (memory dict addr->word, startPC) zurück."""
+    memory = {}
+    i = 0
+
+    # PHASE 1: Hardware RIM-Mode - Wortpaare (dio addr / Daten)
+    while True:
+        if i >= len(words):
+            raise ValueError("%s: tape ends without start address" % name)
+        first = words[i]
+        opcode = first >> 12
+        if first == RIM_END_MARKER:
+            i += 1
+            break
+        if i + 1 >= len(words):
+            raise ValueError("%s: incomplete word pair" % name)
+        if opcode == 0o32:
+            memory[first & 0o7777] = words[i + 1]
+        elif opcode == 0o60:
+            # Reines RIM-Tape: jmp start beendet das Laden
+            return memory, first & 0o7777
+        i += 2
+
+    # PHASE 2: Blöcke des Loaders bei 7751 - dio first, dio end, Daten, Prüfsumme
+    while i < len(words):
+        first = words[i]
+        opcode = first >> 12
+        if opcode == 0o60:
+            return memory, first & 0o7777
+        if opcode != 0o32 or i + 1 >= len(words):
+            raise ValueError("%s: unexpected word %06o at tape word %d" % (name, first, i))
+        start = first & 0o7777
+        end = words[i + 1] & 0o7777
+        if end < start or i + 2 + (end - start) >= len(words):
+            raise ValueError("%s: bad block %04o-%04o" % (name, start, end))
+        data = words[i + 2:i + 2 + (end - start)]
+        checksum = words[i + 2 + (end - start)]
+
+        total = 0
+        for w in [first, words[i + 1]] + data:
+            total = ones_add(total, w)
+        if total != checksum:
+            raise ValueError("%s: checksum error in block %04o-%04o (%06o != %06o)"
+                             % (name, start, end, total, checksum))
+
+        for offset, w in enumerate(data):
+            memory[start + offset] = w
+        i += 3 + (end - start)
+
+    raise ValueError("%s: tape ends without start address" % name)
+
+
+def make_runs(memory):
+    # Zusammenhängende Adressen zu Runs zusammenfassen
+    runs = []
+    for addr in sorted(memory):
+        if runs and runs[-1][0] + len(runs[-1][1]) == addr:
+            runs[-1][1].append(memory[addr])
+        else:
+            runs.append((addr, [memory[addr]]))
+    return runs
+
+
+def c_identifier(name):
+    ident = re.sub(r"[^A-Za-z0-9_]", "_", name)
+    if ident[0].isdigit():
+        ident = "_" + ident
+    return ident
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    program_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "programs")
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(
+        root, "arduino", "pdp1_simulator_multicore", "core_images.h")
+
+    files = sorted(f for f in os.listdir(program_dir) if f.lower().endswith(".rim"))
+
+    lines = []
+    lines.append("// GENERIERT von tools/rim2core.py - nicht von Hand bearbeiten!")
+    lines.append("// Quelle: programs/*.rim")
+    lines.append("")
+    lines.append("#ifndef CORE_IMAGES_H")
+    lines.append("#define CORE_IMAGES_H")
+    lines.append("")
+
+    table = []
+    for f in files:
+        name = os.path.splitext(f)[0]
+        ident = c_identifier(name)
+        with open(os.path.join(program_dir, f), "rb") as fh:
+            memory, start_pc = load_rim(read_words(fh.read()), f)
+        runs = make_runs(memory)
+
+        lines.append("// %s: %d words in %d runs, start %04o" % (f, len(memory), len(runs), start_pc))
+        for n, (addr, data) in enumerate(runs):
+            lines.append("static constexpr uint32_t core_%s_run%d[] = {" % (ident, n))
+            for k in range(0, len(data), 8):
+                lines.append("    " + ", ".join("0%06o" % w for w in data[k:k + 8]) + ",")
+            lines.append("};")
+        lines.append("static constexpr CoreRun core_%s_runs[] = {" % ident)
+        for n, (addr, data) in enumerate(runs):
+            lines.append("    { 0%04o, %d, core_%s_run%d }," % (addr, len(data), ident, n))
+        lines.append("};")
+        lines.append("")
+        table.append((name, start_pc, ident, len(runs)))
+        print("%-20s %4d words, %2d runs, start %04o" % (f, len(memory), len(runs), start_pc))
+
+    lines.append("static constexpr CoreImage coreImages[] = {")
+    for name, start_pc, ident, count in table:
+        lines.append("    { \"%s\", 0%04o, core_%s_runs, %d }," % (name, start_pc, ident, count))
+    if not table:
+        lines.append("    { \"\", 0, nullptr, 0 },")
+    lines.append("};")
+    lines.append("")
+    lines.append("static constexpr size_t CORE_IMAGE_COUNT = %d;" % len(table))
+    lines.append("")
+    lines.append("#endif // CORE_IMAGES_H")
+
+    with open(output, "w") as fh:
+        fh.write("\n".join(lines) + "\n")
+    print("written: %s" % output)
+
+
+if __name__ == "__main__":
+    main()